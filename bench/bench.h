@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 교체한 전역 operator new/delete에 붙인다.
+// 인라인되면 GCC가 malloc/free를 new/delete 짝으로 보지 않아 -Wmismatched-new-delete 경고를 낸다.
+#ifdef _MSC_VER
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+// 마이크로벤치마크 공용 도구
+namespace bench
+{
+using _clock_t = std::chrono::steady_clock;
+
+struct Result
+{
+	std::string name;
+	uint32_t threads = 1;
+	uint64_t ops = 0;
+	double nsPerOp = 0.0;	// 스레드 하나 기준 연산당 시간
+	double mopsPerSec = 0.0;	// 전체 처리량
+	double allocsPerOp = -1.0;	// 연산당 힙 할당 횟수(음수일 경우 측정하지 않음)
+};
+using _result_list_t = std::vector<Result>;
+
+using _bench_func_t = std::function<void(_result_list_t& t_results)>;
+using _bench_list_t = std::vector<std::pair<std::string, _bench_func_t>>;
+
+inline _bench_list_t& GetBenchList()
+{
+	static _bench_list_t list;
+	return list;
+}
+
+// 전역 객체로 선언하여 벤치마크를 등록한다.
+struct Registrar
+{
+	Registrar(const std::string& t_name, _bench_func_t&& t_func)
+	{
+		GetBenchList().emplace_back(t_name, std::move(t_func));
+	}
+};
+
+// 전역 operator new 호출 횟수(microbench.cpp, net_bench.cpp에서 집계한다.)
+inline std::atomic<uint64_t>& GetAllocationCounter()
+{
+	static std::atomic<uint64_t> counter{ 0 };
+	return counter;
+}
+
+inline double ElapsedNs(const _clock_t::time_point& t_begin, const _clock_t::time_point& t_end)
+{
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t_end - t_begin).count());
+}
+
+inline Result MakeResult(const std::string& t_name, const uint32_t t_threads, const uint64_t t_opsPerThread, const double t_elapsedNs)
+{
+	Result result;
+	result.name = t_name;
+	result.threads = t_threads;
+	result.ops = t_opsPerThread * t_threads;
+	result.nsPerOp = t_elapsedNs / static_cast<double>(t_opsPerThread);
+	result.mopsPerSec = static_cast<double>(result.ops) * 1000.0 / t_elapsedNs;
+	return result;
+}
+
+inline void Print(const Result& t_result)
+{
+	std::cout << std::left << std::setw(48) << t_result.name
+		<< std::right << std::setw(4) << t_result.threads << " thr"
+		<< std::setw(12) << std::fixed << std::setprecision(1) << t_result.nsPerOp << " ns/op"
+		<< std::setw(12) << std::fixed << std::setprecision(2) << t_result.mopsPerSec << " Mops/s";
+
+	if (0.0 <= t_result.allocsPerOp)
+	{
+		std::cout << std::setw(12) << std::fixed << std::setprecision(3) << t_result.allocsPerOp << " allocs/op";
+	}
+
+	std::cout << std::endl;
+}
+
+// 단일 스레드에서 t_func(t_ops번의 연산을 수행)의 시간과 힙 할당 횟수를 측정한다.
+template <typename Func>
+inline Result Measure(const std::string& t_name, const uint64_t t_ops, Func&& t_func)
+{
+	uint64_t allocations = GetAllocationCounter().load(std::memory_order_relaxed);
+	auto begin = _clock_t::now();
+
+	t_func();
+
+	auto end = _clock_t::now();
+	allocations = GetAllocationCounter().load(std::memory_order_relaxed) - allocations;
+
+	Result result = MakeResult(t_name, 1, t_ops, ElapsedNs(begin, end));
+	result.allocsPerOp = static_cast<double>(allocations) / static_cast<double>(t_ops);
+	return result;
+}
+
+// 컴파일러가 결과를 제거하지 못하도록 한다.
+template <typename T>
+inline void DoNotOptimize(const T& t_value)
+{
+#ifdef _MSC_VER
+	static volatile char sink;
+	sink = *reinterpret_cast<const volatile char*>(&t_value);
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(t_value) : "memory");
+#endif
+}
+}
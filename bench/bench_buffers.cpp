@@ -0,0 +1,330 @@
+#include <memory>
+#include <random>
+#include <vector>
+#include "bench.h"
+#include "stream_buffer.h"
+#include "network_impl.h"
+#include "session.h"
+
+// 송수신 버퍼 자료구조
+// - StreamBuffer : 수신 링 버퍼(프레임 단위 쓰기/읽기, HandleRead와 같은 Prepare/Commit 수신, 확장)
+// - WriteBufferImpl : 작은 버퍼(union)와 2배씩 늘어나는 Grow
+// - WriteQueue : 메시지 참조 보관, Gather, 부분 전송 Consume
+// 프레임 크기는 실제 트래픽과 비슷하게 작은 메시지 위주로 섞는다.
+namespace
+{
+constexpr int32_t HEADER_SIZE = static_cast<int32_t>(sizeof(int32_t));
+constexpr std::size_t NUMBER_OF_SIZES = 4096;
+
+// 프레임 크기 분포(크기, 가중치)
+const std::vector<std::pair<int32_t, double>> FRAME_MIX = {
+	{ 32, 20.0 }, { 64, 25.0 }, { 128, 20.0 }, { 256, 15.0 }, { 512, 10.0 }, { 1024, 7.0 }, { 4096, 3.0 },
+};
+
+std::vector<int32_t> MakeSizes()
+{
+	std::vector<double> weights;
+	for (auto& mix : FRAME_MIX)
+	{
+		weights.push_back(mix.second);
+	}
+
+	std::mt19937 random(20195);
+	std::discrete_distribution<std::size_t> distribution(weights.begin(), weights.end());
+
+	std::vector<int32_t> sizes(NUMBER_OF_SIZES);
+	for (auto& size : sizes)
+	{
+		size = FRAME_MIX[distribution(random)].first;
+	}
+	return sizes;
+}
+
+const std::vector<int32_t>& GetSizes()
+{
+	static const std::vector<int32_t> sizes = MakeSizes();
+	return sizes;
+}
+
+// 길이 헤더 + 데이터
+std::vector<uint8_t> MakeFrame(const int32_t t_length)
+{
+	std::vector<uint8_t> frame(HEADER_SIZE + t_length, 0x5a);
+	memcpy(frame.data(), &t_length, HEADER_SIZE);
+	return frame;
+}
+
+#pragma region R_STREAM_BUFFER
+// 프레임을 쓰고 2개가 쌓이면 앞의 프레임을 꺼낸다.(쓰기/읽기 위치가 계속 돌면서 끝에서 나뉘는 프레임이 생긴다.)
+bench::Result StreamBufferFrameMix(const uint64_t t_ops)
+{
+	const auto& sizes = GetSizes();
+
+	std::vector<std::vector<uint8_t>> frames;
+	for (auto& mix : FRAME_MIX)
+	{
+		frames.push_back(MakeFrame(mix.first));
+	}
+	auto findFrame = [&frames](const int32_t t_length) -> const std::vector<uint8_t>& {
+		for (auto& frame : frames)
+		{
+			if (static_cast<int32_t>(frame.size()) == HEADER_SIZE + t_length)
+			{
+				return frame;
+			}
+		}
+		return frames.front();
+	};
+
+	StreamBuffer<16 * 1024> buffer;
+	std::vector<uint8_t> scratch(4096);
+	uint64_t contiguous = 0;
+
+	auto result = bench::Measure("stream_buffer frame mix write/peek/consume", t_ops, [&]() {
+		uint32_t pending = 0;
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			auto& frame = findFrame(sizes[i & (NUMBER_OF_SIZES - 1)]);
+			buffer.Write(frame.data(), static_cast<int32_t>(frame.size()));
+
+			if (2 > ++pending)
+			{
+				continue;
+			}
+
+			int32_t length = 0;
+			buffer.Read(reinterpret_cast<uint8_t*>(&length), HEADER_SIZE);
+
+			const uint8_t* data = buffer.Peek(HEADER_SIZE + length);
+			if (nullptr != data)
+			{
+				bench::DoNotOptimize(data[HEADER_SIZE]);
+				buffer.Consume(HEADER_SIZE + length);
+				++contiguous;
+			}
+			else
+			{
+				buffer.Consume(HEADER_SIZE);
+				buffer.ReadAndConsume(scratch.data(), length);
+				bench::DoNotOptimize(scratch[0]);
+			}
+			--pending;
+		}
+	});
+
+	bench::DoNotOptimize(contiguous);
+	return result;
+}
+
+// Session::HandleRead와 같이 빈 공간에 세그먼트(1460byte) 단위로 받고 완성된 프레임을 꺼낸다.
+bench::Result StreamBufferReceive(const uint64_t t_ops)
+{
+	constexpr int32_t SEGMENT_SIZE = 1460;
+
+	// 프레임을 이어 붙인 수신 스트림
+	std::vector<uint8_t> stream;
+	for (auto& size : GetSizes())
+	{
+		auto frame = MakeFrame(size);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+
+	StreamBuffer<16 * 1024> buffer;
+	std::vector<uint8_t> scratch(4096);
+	std::array<std::pair<uint8_t*, int32_t>, 2> regions;
+
+	std::size_t offset = 0;
+	uint64_t frames = 0;
+
+	return bench::Measure("stream_buffer receive prepare/commit/peek", t_ops, [&]() {
+		while (frames < t_ops)
+		{
+			int32_t length = static_cast<int32_t>(std::min<std::size_t>(SEGMENT_SIZE, stream.size() - offset));
+			buffer.Prepare(length, regions);
+
+			int32_t copied = 0;
+			for (auto& region : regions)
+			{
+				int32_t n = std::min(region.second, length - copied);
+				memcpy(region.first, stream.data() + offset + copied, n);
+				copied += n;
+			}
+
+			buffer.Commit(length);
+			offset = (offset + length) % stream.size();
+
+			while (HEADER_SIZE <= buffer.GetLength())
+			{
+				int32_t dataLength = 0;
+				buffer.Read(reinterpret_cast<uint8_t*>(&dataLength), HEADER_SIZE);
+				if ((HEADER_SIZE + dataLength) > buffer.GetLength())
+				{
+					break;
+				}
+
+				const uint8_t* data = buffer.Peek(HEADER_SIZE + dataLength);
+				if (nullptr != data)
+				{
+					bench::DoNotOptimize(data[HEADER_SIZE]);
+					buffer.Consume(HEADER_SIZE + dataLength);
+				}
+				else
+				{
+					buffer.Consume(HEADER_SIZE);
+					buffer.ReadAndConsume(scratch.data(), dataLength);
+					bench::DoNotOptimize(scratch[0]);
+				}
+				++frames;
+			}
+		}
+	});
+}
+
+// 기본 크기(1KB)에서 64KB까지 1KB씩 써서 확장한다.(버퍼마다 새로 생성)
+bench::Result StreamBufferGrow(const uint64_t t_ops)
+{
+	constexpr int32_t CHUNK_SIZE = 1024;
+	constexpr int32_t TOTAL_SIZE = 64 * 1024;
+
+	std::vector<uint8_t> chunk(CHUNK_SIZE, 0x5a);
+
+	return bench::Measure("stream_buffer grow 1KB -> 64KB", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			StreamBuffer<1024> buffer;
+			for (int32_t written = 0; written < TOTAL_SIZE; written += CHUNK_SIZE)
+			{
+				buffer.Write(chunk.data(), CHUNK_SIZE);
+			}
+			bench::DoNotOptimize(buffer.GetLength());
+		}
+	});
+}
+#pragma endregion R_STREAM_BUFFER
+
+#pragma region R_WRITE_BUFFER
+// 작은 버퍼에 들어가는 크기(확장 없음)
+bench::Result WriteBufferSmall(const uint64_t t_ops)
+{
+	constexpr std::size_t LENGTH = net::WriteBufferImpl::DEFAULT_BUFFER_SIZE - net::WriteBufferImpl::RESERVED_SPACE_SIZE;
+	std::vector<uint8_t> data(LENGTH, 0x5a);
+
+	return bench::Measure("write_buffer small (no grow)", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			net::WriteBufferImpl buffer;
+			buffer.Put(data.data(), data.size());
+			buffer.Commit();
+			bench::DoNotOptimize(buffer.GetData()[0]);
+		}
+	});
+}
+
+// 프레임 크기 분포대로 한번에 Put(대부분 한번 확장)
+bench::Result WriteBufferFrameMix(const uint64_t t_ops)
+{
+	const auto& sizes = GetSizes();
+	std::vector<uint8_t> data(4096, 0x5a);
+
+	return bench::Measure("write_buffer frame mix single put", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			net::WriteBufferImpl buffer;
+			buffer.Put(data.data(), sizes[i & (NUMBER_OF_SIZES - 1)]);
+			buffer.Commit();
+			bench::DoNotOptimize(buffer.GetData()[0]);
+		}
+	});
+}
+
+// 64KB를 256byte씩 나누어 Put(2배씩 확장하는 경로)
+bench::Result WriteBufferGrow(const uint64_t t_ops)
+{
+	constexpr std::size_t CHUNK_SIZE = 256;
+	constexpr std::size_t TOTAL_SIZE = 64 * 1024;
+	std::vector<uint8_t> chunk(CHUNK_SIZE, 0x5a);
+
+	return bench::Measure("write_buffer grow 256B puts -> 64KB", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			net::WriteBufferImpl buffer;
+			for (std::size_t written = 0; written < TOTAL_SIZE; written += CHUNK_SIZE)
+			{
+				buffer.Put(chunk.data(), CHUNK_SIZE);
+			}
+			buffer.Commit();
+			bench::DoNotOptimize(buffer.GetLength());
+		}
+	});
+}
+#pragma endregion R_WRITE_BUFFER
+
+#pragma region R_WRITE_QUEUE
+// 메시지 t_batch개를 넣고 한번에 모아서 모두 보낸 것으로 처리한다.(연산 = 메시지)
+bench::Result WriteQueueBatch(const uint64_t t_ops, const std::size_t t_batch)
+{
+	const auto& sizes = GetSizes();
+	std::shared_ptr<uint8_t> data(new uint8_t[4096], std::default_delete<uint8_t[]>());
+
+	net::WriteQueue queue;
+
+	return bench::Measure("write_queue put/gather/consume x" + std::to_string(t_batch), t_ops, [&]() {
+		uint64_t i = 0;
+		while (i < t_ops)
+		{
+			for (std::size_t n = 0; n < t_batch; ++n, ++i)
+			{
+				queue.Put(data, data.get(), sizes[i & (NUMBER_OF_SIZES - 1)], net::LatencyStamp());
+			}
+
+			while (false == queue.IsEmpty())
+			{
+				auto buffers = queue.Gather();
+				queue.Consume(boost::asio::buffer_size(buffers));
+			}
+		}
+	});
+}
+
+// 한번에 다 보내지 못하고 세그먼트(1460byte) 단위로 나누어 보낸 것으로 처리한다.
+bench::Result WriteQueuePartial(const uint64_t t_ops)
+{
+	constexpr std::size_t BATCH = 64;
+	constexpr std::size_t SEGMENT_SIZE = 1460;
+
+	const auto& sizes = GetSizes();
+	std::shared_ptr<uint8_t> data(new uint8_t[4096], std::default_delete<uint8_t[]>());
+
+	net::WriteQueue queue;
+
+	return bench::Measure("write_queue partial consume (1460B)", t_ops, [&]() {
+		uint64_t i = 0;
+		while (i < t_ops)
+		{
+			for (std::size_t n = 0; n < BATCH; ++n, ++i)
+			{
+				queue.Put(data, data.get(), sizes[i & (NUMBER_OF_SIZES - 1)], net::LatencyStamp());
+			}
+
+			while (false == queue.IsEmpty())
+			{
+				auto buffers = queue.Gather();
+				queue.Consume(std::min(SEGMENT_SIZE, boost::asio::buffer_size(buffers)));
+			}
+		}
+	});
+}
+#pragma endregion R_WRITE_QUEUE
+
+bench::Registrar registrar("buffers", [](bench::_result_list_t& t_results) {
+	t_results.push_back(StreamBufferFrameMix(4000000));
+	t_results.push_back(StreamBufferReceive(4000000));
+	t_results.push_back(StreamBufferGrow(2000));
+	t_results.push_back(WriteBufferSmall(10000000));
+	t_results.push_back(WriteBufferFrameMix(4000000));
+	t_results.push_back(WriteBufferGrow(2000));
+	t_results.push_back(WriteQueueBatch(4000000, 1));
+	t_results.push_back(WriteQueueBatch(4000000, 16));
+	t_results.push_back(WriteQueuePartial(4000000));
+});
+}
@@ -0,0 +1,162 @@
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include "bench.h"
+#include "session_table.h"
+
+// SessionManager 조회 비교
+// - MapTable : 이전 구현(증가하는 sid + std::map + std::shared_mutex)
+// - SessionTable : 세대 기반 슬롯맵 + epoch 기반 무잠금 조회
+// 조회 스레드 수를 늘려가며 측정하고, 별도 스레드 하나가 세션 추가/삭제를 계속 반복한다.
+namespace
+{
+using _value_t = boost::shared_ptr<int32_t>;
+
+class MapTable
+{
+public:
+	explicit MapTable(const uint32_t /*t_numberOfShards*/)
+	{
+	}
+
+	net::_sid_t Reserve(const uint32_t /*t_shard*/)
+	{
+		return ++m_currentSID;
+	}
+
+	bool Lookup(const net::_sid_t& t_sid, _value_t& t_value)
+	{
+		std::shared_lock lock(m_rwMutex);
+
+		auto itr = m_map.find(t_sid);
+		if (itr == m_map.end())
+		{
+			return false;
+		}
+
+		t_value = itr->second;
+		return true;
+	}
+
+	bool Add(const net::_sid_t& t_sid, const _value_t& t_value)
+	{
+		std::unique_lock lock(m_rwMutex);
+		return m_map.emplace(t_sid, t_value).second;
+	}
+
+	void Remove(const net::_sid_t& t_sid)
+	{
+		std::unique_lock lock(m_rwMutex);
+		m_map.erase(t_sid);
+	}
+
+private:
+	std::atomic<net::_sid_t> m_currentSID{ 0 };
+	std::shared_mutex m_rwMutex;
+	std::map<net::_sid_t, _value_t> m_map;
+};
+
+constexpr uint64_t NUMBER_OF_SESSIONS = 100000;
+constexpr uint32_t NUMBER_OF_SHARDS = 8;
+constexpr uint64_t LOOKUPS_PER_THREAD = 1000000;
+
+template <typename Table>
+bench::Result Run(const std::string& t_name, const uint32_t t_threads)
+{
+	Table table(NUMBER_OF_SHARDS);
+	auto value = boost::make_shared<int32_t>(0);
+
+	std::deque<net::_sid_t> live;
+	for (uint64_t i = 0; i < NUMBER_OF_SESSIONS; ++i)
+	{
+		net::_sid_t sid = table.Reserve(static_cast<uint32_t>(i % NUMBER_OF_SHARDS));
+		table.Add(sid, value);
+		live.push_back(sid);
+	}
+
+	// 조회 대상은 초기 세션 목록에서 고른다.(쓰기 스레드가 종료시킨 sid는 조회에 실패해야 한다.)
+	const std::vector<net::_sid_t> initial(live.begin(), live.end());
+
+	std::atomic<bool> running{ true };
+	std::atomic<uint32_t> ready{ 0 };
+
+	// 접속/종료를 흉내내는 쓰기 스레드(가장 오래된 세션을 지우고 새 세션을 추가, 초당 약 10만 회)
+	std::thread writer([&]() {
+		uint32_t shard = 0;
+		while (true == running.load(std::memory_order_relaxed))
+		{
+			table.Remove(live.front());
+			live.pop_front();
+
+			net::_sid_t sid = table.Reserve(++shard % NUMBER_OF_SHARDS);
+			table.Add(sid, value);
+			live.push_back(sid);
+
+			std::this_thread::sleep_for(std::chrono::microseconds(10));
+		}
+	});
+
+	std::vector<std::thread> readers;
+	std::vector<double> elapsed(t_threads, 0.0);
+	for (uint32_t t = 0; t < t_threads; ++t)
+	{
+		readers.emplace_back([&, t]() {
+			std::mt19937_64 random(t + 1);
+			std::vector<net::_sid_t> keys(65536);
+			for (auto& key : keys)
+			{
+				key = initial[random() % initial.size()];
+			}
+
+			ready.fetch_add(1);
+			while (t_threads > ready.load())
+			{
+			}
+
+			_value_t found;
+			uint64_t hits = 0;
+			auto begin = bench::_clock_t::now();
+			for (uint64_t i = 0; i < LOOKUPS_PER_THREAD; ++i)
+			{
+				hits += table.Lookup(keys[i & (keys.size() - 1)], found) ? 1 : 0;
+			}
+			auto end = bench::_clock_t::now();
+
+			bench::DoNotOptimize(hits);
+			elapsed[t] = bench::ElapsedNs(begin, end);
+		});
+	}
+
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+
+	running.store(false);
+	writer.join();
+
+	double maxElapsed = 0.0;
+	for (auto& e : elapsed)
+	{
+		maxElapsed = std::max(maxElapsed, e);
+	}
+
+	return bench::MakeResult(t_name, t_threads, LOOKUPS_PER_THREAD, maxElapsed);
+}
+
+bench::Registrar registrar("session_table", [](bench::_result_list_t& t_results) {
+	uint32_t maxThreads = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+	for (uint32_t threads = 1; threads <= maxThreads; threads <<= 1)
+	{
+		t_results.push_back(Run<MapTable>("lookup map+shared_mutex", threads));
+		t_results.push_back(Run<net::SessionTable<_value_t>>("lookup SessionTable", threads));
+	}
+});
+}
@@ -0,0 +1,147 @@
+#include <memory>
+#include <random>
+#include <vector>
+#include <boost/asio.hpp>
+#include "bench.h"
+#include "timer_wheel.h"
+
+// 세션 타이머
+// - TimerWheel : 세션마다 하나의 노드를 두고 수신/송신마다 다시 거는 경우(O(1), 할당 없음)
+// - steady_timer : 이전 구현(expires_after + async_wait, 다시 걸 때마다 대기 중인 핸들러가 취소된다.)
+// 세션 수만큼 타이머를 걸어두고 임의의 세션을 골라 다시 건다.
+namespace
+{
+constexpr std::size_t NUMBER_OF_TIMERS = 100000;
+constexpr std::size_t NUMBER_OF_INDEXES = 4096;
+
+class CountNode : public net::TimerWheel::Node
+{
+public:
+	virtual void OnExpire() override { ++expired; }
+
+	uint64_t expired = 0;
+};
+
+std::vector<std::size_t> MakeIndexes()
+{
+	std::mt19937 random(20195);
+	std::uniform_int_distribution<std::size_t> distribution(0, NUMBER_OF_TIMERS - 1);
+
+	std::vector<std::size_t> indexes(NUMBER_OF_INDEXES);
+	for (auto& index : indexes)
+	{
+		index = distribution(random);
+	}
+	return indexes;
+}
+
+// 임의의 세션을 골라 30초(3000tick) 뒤로 다시 건다.
+bench::Result WheelReschedule(const uint64_t t_ops)
+{
+	const auto indexes = MakeIndexes();
+	const uint64_t timeout = net::TimerWheel::ToTicks(30000);
+
+	// 휠이 먼저 해제되어야 한다.(남은 노드를 떼어낸다.)
+	std::unique_ptr<CountNode[]> nodes(new CountNode[NUMBER_OF_TIMERS]);
+	net::TimerWheel wheel;
+	for (std::size_t i = 0; i < NUMBER_OF_TIMERS; ++i)
+	{
+		wheel.Schedule(nodes[i], timeout);
+	}
+
+	return bench::Measure("timer_wheel reschedule (100k timers)", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			wheel.Schedule(nodes[indexes[i & (NUMBER_OF_INDEXES - 1)]], wheel.GetTick() + timeout);
+
+			// 가끔 tick을 진행해서 상위 레벨에서 내려오는 경우도 포함한다.
+			if (0 == (i & 1023))
+			{
+				wheel.Advance(wheel.GetTick() + 1);
+			}
+		}
+	});
+}
+
+// 1~4096tick 사이에 흩어진 타이머를 모두 만료시킨다.(ops = 만료된 타이머 수)
+bench::Result WheelExpire(const uint64_t t_rounds)
+{
+	std::mt19937 random(20195);
+	std::uniform_int_distribution<uint64_t> distribution(1, 4096);
+
+	// 휠이 먼저 해제되어야 한다.(남은 노드를 떼어낸다.)
+	std::unique_ptr<CountNode[]> nodes(new CountNode[NUMBER_OF_TIMERS]);
+	net::TimerWheel wheel;
+
+	uint64_t expired = 0;
+	auto result = bench::Measure("timer_wheel schedule/advance/expire", t_rounds * NUMBER_OF_TIMERS, [&]() {
+		for (uint64_t round = 0; round < t_rounds; ++round)
+		{
+			uint64_t tick = wheel.GetTick();
+			for (std::size_t i = 0; i < NUMBER_OF_TIMERS; ++i)
+			{
+				wheel.Schedule(nodes[i], tick + distribution(random));
+			}
+
+			wheel.Advance(tick + 4096);
+		}
+	});
+
+	for (std::size_t i = 0; i < NUMBER_OF_TIMERS; ++i)
+	{
+		expired += nodes[i].expired;
+	}
+	bench::DoNotOptimize(expired);
+	return result;
+}
+
+// 이전 구현과 같이 steady_timer를 다시 건다.(취소된 핸들러는 주기적으로 poll에서 처리한다.)
+bench::Result SteadyTimerReschedule(const uint64_t t_ops)
+{
+	const auto indexes = MakeIndexes();
+
+	boost::asio::io_context ioContext;
+	std::vector<std::unique_ptr<boost::asio::steady_timer>> timers;
+	for (std::size_t i = 0; i < NUMBER_OF_TIMERS; ++i)
+	{
+		timers.emplace_back(new boost::asio::steady_timer(ioContext));
+	}
+
+	uint64_t aborted = 0;
+	auto handler = [&aborted](const boost::system::error_code& t_errorCode) {
+		if (boost::asio::error::operation_aborted == t_errorCode)
+		{
+			++aborted;
+		}
+	};
+
+	auto result = bench::Measure("steady_timer reschedule (100k timers)", t_ops, [&]() {
+		for (uint64_t i = 0; i < t_ops; ++i)
+		{
+			auto& timer = timers[indexes[i & (NUMBER_OF_INDEXES - 1)]];
+			timer->expires_after(std::chrono::seconds(30));
+			timer->async_wait(handler);
+
+			if (0 == (i & 1023))
+			{
+				ioContext.poll();
+			}
+		}
+	});
+
+	for (auto& timer : timers)
+	{
+		timer->cancel();
+	}
+	ioContext.poll();
+
+	bench::DoNotOptimize(aborted);
+	return result;
+}
+
+bench::Registrar registrar("timer_wheel", [](bench::_result_list_t& t_results) {
+	t_results.push_back(WheelReschedule(10000000));
+	t_results.push_back(WheelExpire(10));
+	t_results.push_back(SteadyTimerReschedule(2000000));
+});
+}
@@ -0,0 +1,60 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "bench.h"
+
+// 연산당 할당 횟수를 세기 위해 전역 operator new를 교체한다.(배열 new도 이 함수를 거친다.)
+BENCH_NOINLINE void* operator new(std::size_t t_size)
+{
+	bench::GetAllocationCounter().fetch_add(1, std::memory_order_relaxed);
+
+	void* pointer = std::malloc(0 < t_size ? t_size : 1);
+	if (nullptr == pointer)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+BENCH_NOINLINE void operator delete(void* t_pointer) noexcept
+{
+	std::free(t_pointer);
+}
+
+BENCH_NOINLINE void operator delete(void* t_pointer, std::size_t) noexcept
+{
+	std::free(t_pointer);
+}
+
+// 사용법 : net_microbench [이름 필터]
+int main(int argc, char* argv[])
+{
+	std::string filter;
+	if (1 < argc)
+	{
+		filter = argv[1];
+	}
+
+	for (auto& bench : bench::GetBenchList())
+	{
+		if (false == filter.empty() && std::string::npos == bench.first.find(filter))
+		{
+			continue;
+		}
+
+		std::cout << "## " << bench.first << std::endl;
+
+		bench::_result_list_t results;
+		bench.second(results);
+
+		for (auto& result : results)
+		{
+			bench::Print(result);
+		}
+
+		std::cout << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,709 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+#include "network_impl.h"
+#include "session.h"
+#include "co_session.h"
+#include "latency_histogram.h"
+#include "cpu_topology.h"
+#include "bench.h"
+
+// 측정 구간의 힙 할당 횟수를 세기 위해 전역 operator new를 교체한다.
+BENCH_NOINLINE void* operator new(std::size_t t_size)
+{
+	bench::GetAllocationCounter().fetch_add(1, std::memory_order_relaxed);
+
+	void* pointer = std::malloc(0 < t_size ? t_size : 1);
+	if (nullptr == pointer)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+BENCH_NOINLINE void operator delete(void* t_pointer) noexcept
+{
+	std::free(t_pointer);
+}
+
+BENCH_NOINLINE void operator delete(void* t_pointer, std::size_t) noexcept
+{
+	std::free(t_pointer);
+}
+
+// 루프백 에코 벤치마크
+// 같은 프로세스에서 서버/클라이언트 NetworkImpl을 띄우고 127.0.0.1로 에코한다.
+// 클라이언트는 연결마다 depth개의 메시지를 보내 두고, 에코를 받을 때마다 하나씩 다시 보낸다.(closed loop)
+// 메시지 앞 8byte에 보낸 시각을 기록하여 왕복 지연 시간을 측정한다.
+// 백엔드(epoll/io_uring, NET_IO_URING) 비교를 위해 커널 CPU 시간과 문맥 교환 수를 메시지당으로 함께 기록한다.
+// spin을 사용하면 io 스레드가 spin/작업/블록에 사용한 시간을 함께 기록한다.(서버 + 클라이언트)
+//
+// 사용법 : net_bench [--name=value ...]
+//   --connections=64		연결 수
+//   --sizes=64			메시지 크기 분포(크기:가중치 목록, 예: 64:0.7,1024:0.25,65536:0.05)
+//   --depth=1			연결당 동시에 보내 둔 메시지 수(pipelining)
+//   --server-threads=2	서버 io 스레드 수
+//   --client-threads=2	클라이언트 io 스레드 수
+//   --duration=10		측정 시간(초)
+//   --warmup=2			측정 전 예열 시간(초)
+//   --model=per_thread	io 실행 모델(per_thread, shared)
+//   --api=callback		서버 에코 방식(callback : IListener, coroutine : CoSession)
+//   --spin=0			io 스레드가 블록하기 전에 poll을 반복할 시간(usec, 0이면 바로 블록)
+//   --busy-poll=0		SO_BUSY_POLL(usec, 0이면 설정하지 않음)
+//   --placement=none		io 스레드 배치(none, core, numa, 서버 워커부터 배정하고 클라이언트 워커는 이어서 배정한다.)
+//   --zero-alloc=0		1이면 측정 구간에 힙 할당이 있을 경우 실패(종료 코드 2)한다.(per_thread, shared 모델 모두)
+//   --port=20200
+//   --output=net_bench_result.json
+namespace bench
+{
+struct Options
+{
+	uint32_t connections = 64;
+	std::string sizes = "64";
+	uint32_t depth = 1;
+	uint32_t serverThreads = 2;
+	uint32_t clientThreads = 2;
+	uint32_t duration = 10;
+	uint32_t warmup = 2;
+	std::string model = "per_thread";
+	std::string api = "callback";
+	uint32_t spin = 0;
+	uint32_t busyPoll = 0;
+	std::string placement = "none";
+	bool zeroAlloc = false;
+	std::string port = "20200";
+	std::string output = "net_bench_result.json";
+};
+
+bool ParseOptions(int argc, char* argv[], Options& t_options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		std::size_t pos = arg.find('=');
+		if (0 != arg.rfind("--", 0) || std::string::npos == pos)
+		{
+			std::cout << "invalid argument: " << arg << std::endl;
+			return false;
+		}
+
+		std::string name = arg.substr(2, pos - 2);
+		std::string value = arg.substr(pos + 1);
+
+		if ("connections" == name) t_options.connections = static_cast<uint32_t>(std::stoul(value));
+		else if ("sizes" == name) t_options.sizes = value;
+		else if ("depth" == name) t_options.depth = static_cast<uint32_t>(std::stoul(value));
+		else if ("server-threads" == name) t_options.serverThreads = static_cast<uint32_t>(std::stoul(value));
+		else if ("client-threads" == name) t_options.clientThreads = static_cast<uint32_t>(std::stoul(value));
+		else if ("duration" == name) t_options.duration = static_cast<uint32_t>(std::stoul(value));
+		else if ("warmup" == name) t_options.warmup = static_cast<uint32_t>(std::stoul(value));
+		else if ("model" == name) t_options.model = value;
+		else if ("api" == name) t_options.api = value;
+		else if ("spin" == name) t_options.spin = static_cast<uint32_t>(std::stoul(value));
+		else if ("busy-poll" == name) t_options.busyPoll = static_cast<uint32_t>(std::stoul(value));
+		else if ("placement" == name) t_options.placement = value;
+		else if ("zero-alloc" == name) t_options.zeroAlloc = ("1" == value || "true" == value);
+		else if ("port" == name) t_options.port = value;
+		else if ("output" == name) t_options.output = value;
+		else
+		{
+			std::cout << "unknown option: " << name << std::endl;
+			return false;
+		}
+	}
+
+	return (0 < t_options.connections && 0 < t_options.depth && 0 < t_options.serverThreads && 0 < t_options.clientThreads && 0 < t_options.duration);
+}
+
+// 메시지 크기 분포(크기:가중치)
+class SizeDistribution
+{
+public:
+	// 보낸 시각을 기록할 최소 크기
+	static constexpr std::size_t MIN_SIZE = sizeof(uint64_t);
+
+	bool Parse(const std::string& t_text)
+	{
+		double total = 0.0;
+
+		std::stringstream stream(t_text);
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			std::size_t pos = item.find(':');
+			std::size_t size = std::stoul(item.substr(0, pos));
+			double weight = (std::string::npos == pos) ? 1.0 : std::stod(item.substr(pos + 1));
+
+			if (0.0 >= weight)
+			{
+				return false;
+			}
+
+			total += weight;
+			m_sizes.push_back(std::max(size, MIN_SIZE));
+			m_cumulative.push_back(total);
+		}
+
+		return (false == m_sizes.empty());
+	}
+
+	// 여러 io 스레드에서 호출하므로 상태를 바꾸지 않는다.
+	template <typename Random>
+	inline std::size_t Next(Random& t_random) const
+	{
+		if (1 == m_sizes.size())
+		{
+			return m_sizes.front();
+		}
+
+		double value = std::uniform_real_distribution<double>(0.0, m_cumulative.back())(t_random);
+		std::size_t index = std::upper_bound(m_cumulative.begin(), m_cumulative.end(), value) - m_cumulative.begin();
+		return m_sizes[std::min(index, m_sizes.size() - 1)];
+	}
+
+	inline std::size_t GetMax() const
+	{
+		return *std::max_element(m_sizes.begin(), m_sizes.end());
+	}
+
+private:
+	std::vector<std::size_t> m_sizes;
+	std::vector<double> m_cumulative;	// 가중치 누적 합
+};
+
+// 프로세스 CPU 사용 시간(ns)과 문맥 교환 수(Windows는 0)
+struct CpuUsage
+{
+	uint64_t user = 0;
+	uint64_t system = 0;
+	uint64_t contextSwitches = 0;
+};
+
+CpuUsage GetProcessCpuUsage()
+{
+	CpuUsage cpu;
+
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (FALSE == GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return cpu;
+	}
+
+	auto toNs = [](const FILETIME& t_time) {
+		return ((static_cast<uint64_t>(t_time.dwHighDateTime) << 32) | t_time.dwLowDateTime) * 100;
+	};
+	cpu.user = toNs(user);
+	cpu.system = toNs(kernel);
+#else
+	rusage usage{};
+	if (0 != getrusage(RUSAGE_SELF, &usage))
+	{
+		return cpu;
+	}
+
+	auto toNs = [](const timeval& t_time) {
+		return static_cast<uint64_t>(t_time.tv_sec) * 1000000000ull + static_cast<uint64_t>(t_time.tv_usec) * 1000ull;
+	};
+	cpu.user = toNs(usage.ru_utime);
+	cpu.system = toNs(usage.ru_stime);
+	cpu.contextSwitches = static_cast<uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+#endif
+
+	return cpu;
+}
+
+class Configuration : public net::IConfiguration
+{
+public:
+	Configuration(const std::string& t_port, const net::eIoModel t_ioModel, std::vector<net::_cpu_list_t>&& t_cpuSets, const uint32_t t_spin, const uint32_t t_busyPoll)
+		: m_port(t_port)
+		, m_ioModel(t_ioModel)
+		, m_cpuSets(std::move(t_cpuSets))
+		, m_spin(static_cast<int32_t>(t_spin))
+		, m_busyPoll(static_cast<int32_t>(t_busyPoll))
+	{
+	}
+
+	virtual _address_t GetAddress() override { return std::make_pair("127.0.0.1", m_port); }
+	virtual _boolopt_t Reuse() override { return _boolopt_t(true); }
+	virtual _sizeopt_t MMS() override { return std::nullopt; }
+	virtual _lingeropt_t Linger() override { return std::nullopt; }
+	virtual _boolopt_t Nagle() override { return _boolopt_t(false); }
+	virtual _boolopt_t Keepalive() override { return std::nullopt; }
+	virtual _iomodelopt_t IoModel() override { return m_ioModel; }
+	virtual _cpusetsopt_t WorkerCpuSets() override { return (true == m_cpuSets.empty()) ? std::nullopt : _cpusetsopt_t(m_cpuSets); }
+	virtual _sizeopt_t SpinTime() override { return m_spin; }
+	virtual _sizeopt_t BusyPoll() override { return (0 < m_busyPoll) ? _sizeopt_t(m_busyPoll) : std::nullopt; }
+	virtual _sizeopt_t MaxFrameLength() override { return (0 < m_maxFrameLength) ? _sizeopt_t(m_maxFrameLength) : std::nullopt; }
+
+	// 가장 큰 메시지가 기본 프레임 한도를 넘으면 그 크기까지 받는다.
+	void AllowFrameLength(const std::size_t t_length)
+	{
+		if (static_cast<std::size_t>(net::Session::DEFAULT_MAX_FRAME_LENGTH) < t_length)
+		{
+			m_maxFrameLength = static_cast<int32_t>(std::min(t_length, static_cast<std::size_t>(net::Session::MAX_FRAME_LENGTH)));
+		}
+	}
+
+private:
+	std::string m_port;
+	net::eIoModel m_ioModel;
+	std::vector<net::_cpu_list_t> m_cpuSets;
+	int32_t m_spin = 0;
+	int32_t m_busyPoll = 0;
+	int32_t m_maxFrameLength = 0;
+};
+
+// 코루틴으로 받은 메시지를 그대로 돌려준다.
+net::CoTask EchoCoroutine(net::CoSession& t_session)
+{
+	while (true)
+	{
+		net::CoMessage message = co_await t_session.ReadMessage();
+		if (!message)
+		{
+			break;
+		}
+
+		net::_write_buffer_ptr_t buffer = t_session.CreateWriteBuffer(message.data.size());
+		buffer->Put(message.data.data(), message.data.size());
+		buffer->Commit();
+
+		co_await t_session.Write(buffer);
+	}
+}
+
+// 받은 메시지를 그대로 돌려준다.
+class EchoServer : public net::IListener, private boost::noncopyable
+{
+public:
+	EchoServer(const uint32_t t_threads, Configuration& t_configuration, const bool t_coroutine)
+		: m_controller(t_threads)
+		, m_coListener(&m_controller, EchoCoroutine)
+	{
+		m_controller.AttachService(true == t_coroutine ? static_cast<net::IListener*>(&m_coListener) : this);
+		m_controller.AttachConfiguration(&t_configuration);
+	}
+
+	inline net::NetworkImpl& GetController() { return m_controller; }
+
+	virtual void OnConnected(const net::_sid_t& /*sid*/) override {}
+	virtual void OnClose(const net::_sid_t& /*sid*/, const boost::system::error_code& /*t_errorCode*/) override {}
+	virtual void OnError(const net::_sid_t& /*sid*/, const boost::system::error_code& /*t_errorCode*/) override {}
+
+	virtual void OnMessage(const net::_sid_t& sid, const uint8_t* data, const std::size_t& len) override
+	{
+		net::_write_buffer_ptr_t buffer = m_controller.CreateWriteBuffer(len);
+		buffer->Put(data, len);
+		buffer->Commit();
+
+		m_controller.Write(sid, buffer);
+	}
+
+private:
+	net::NetworkImpl m_controller;
+	net::CoListener m_coListener;
+};
+
+// 에코를 받을 때마다 지연 시간을 기록하고 다음 메시지를 보낸다.
+class EchoClient : public net::IListener, private boost::noncopyable
+{
+	// io 스레드별 통계(자신의 스레드에서만 기록)
+	struct alignas(64) Stats
+	{
+		net::LatencyHistogram latency;
+		std::atomic<uint64_t> messages{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+	};
+
+public:
+	EchoClient(const uint32_t t_threads, Configuration& t_configuration, const SizeDistribution& t_sizes)
+		: m_controller(t_threads)
+		, m_sizes(t_sizes)
+		, m_padding(t_sizes.GetMax(), 0)
+	{
+		for (uint32_t i = 0; i < t_threads; ++i)
+		{
+			m_stats.emplace_back(new Stats);
+		}
+
+		m_controller.AttachService(this);
+		m_controller.AttachConfiguration(&t_configuration);
+	}
+
+	inline net::NetworkImpl& GetController() { return m_controller; }
+
+	inline uint32_t GetConnected() const { return m_connected.load(std::memory_order_acquire); }
+
+	inline void SetMeasuring(const bool t_measuring) { m_measuring.store(t_measuring, std::memory_order_release); }
+
+	inline void Stop() { m_stopped.store(true, std::memory_order_release); }
+
+	void Send(const net::_sid_t& t_sid)
+	{
+		thread_local std::mt19937_64 random(std::random_device{}());
+
+		std::size_t size = m_sizes.Next(random);
+		uint64_t now = net::LatencyHistogram::Now();
+
+		net::_write_buffer_ptr_t buffer = m_controller.CreateWriteBuffer(size);
+		buffer->Put(&now, sizeof(now));
+		buffer->Put(m_padding.data(), size - sizeof(now));
+		buffer->Commit();
+
+		m_controller.Write(t_sid, buffer);
+	}
+
+	virtual void OnConnected(const net::_sid_t& /*sid*/) override
+	{
+		m_connected.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	virtual void OnClose(const net::_sid_t& /*sid*/, const boost::system::error_code& /*t_errorCode*/) override {}
+
+	virtual void OnError(const net::_sid_t& sid, const boost::system::error_code& t_errorCode) override
+	{
+		std::cout << "error - sid:" << sid << ", message=" << t_errorCode.message() << std::endl;
+	}
+
+	virtual void OnMessage(const net::_sid_t& sid, const uint8_t* data, const std::size_t& len) override
+	{
+		if (true == m_measuring.load(std::memory_order_relaxed) && sizeof(uint64_t) <= len)
+		{
+			net::IoWorker* worker = net::IoWorker::Current();
+			if (nullptr != worker)
+			{
+				uint64_t sent = 0;
+				memcpy(&sent, data, sizeof(sent));
+
+				Stats& stats = *m_stats[worker->GetIndex()];
+				stats.latency.Record(net::LatencyHistogram::Now() - sent);
+				stats.messages.store(stats.messages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				stats.bytes.store(stats.bytes.load(std::memory_order_relaxed) + len + sizeof(int32_t), std::memory_order_relaxed);
+			}
+		}
+
+		if (false == m_stopped.load(std::memory_order_acquire))
+		{
+			Send(sid);
+		}
+	}
+
+	// io 스레드별 통계를 합친다.
+	void Merge(net::LatencyHistogram& t_latency, uint64_t& t_messages, uint64_t& t_bytes)
+	{
+		for (auto& stats : m_stats)
+		{
+			t_latency.Merge(stats->latency);
+			t_messages += stats->messages.load(std::memory_order_relaxed);
+			t_bytes += stats->bytes.load(std::memory_order_relaxed);
+		}
+	}
+
+private:
+	net::NetworkImpl m_controller;
+	const SizeDistribution& m_sizes;
+	std::vector<uint8_t> m_padding;
+
+	std::vector<std::unique_ptr<Stats>> m_stats;
+	std::atomic<uint32_t> m_connected{ 0 };
+	std::atomic<bool> m_measuring{ false };
+	std::atomic<bool> m_stopped{ false };
+};
+
+struct Report
+{
+	double seconds = 0.0;
+	uint64_t messages = 0;
+	uint64_t bytes = 0;
+	double messagesPerSec = 0.0;
+	double mbPerSec = 0.0;
+	double cpuNsPerMessage = 0.0;
+	double systemNsPerMessage = 0.0;
+	double contextSwitchesPerMessage = 0.0;
+	uint64_t allocations = 0;
+	double allocationsPerMessage = 0.0;
+	uint64_t spinNs = 0;
+	uint64_t workNs = 0;
+	uint64_t blockNs = 0;
+	uint64_t blocks = 0;
+	uint64_t p50 = 0;
+	uint64_t p90 = 0;
+	uint64_t p99 = 0;
+	uint64_t p999 = 0;
+	uint64_t max = 0;
+};
+
+// 서버와 클라이언트 io 스레드의 spin/작업/블록 시간 합계
+net::Throughput GetIoTime(net::IController& t_server, net::IController& t_client)
+{
+	net::Throughput total;
+	for (auto controller : { &t_server, &t_client })
+	{
+		net::MetricsSnapshot snapshot;
+		controller->Snapshot(snapshot);
+
+		total.spinTime += snapshot.total.spinTime;
+		total.workTime += snapshot.total.workTime;
+		total.blockTime += snapshot.total.blockTime;
+		total.blocks += snapshot.total.blocks;
+	}
+	return total;
+}
+
+void Print(const Options& t_options, const Report& t_report)
+{
+	auto us = [](const uint64_t t_ns) { return static_cast<double>(t_ns) / 1000.0; };
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "connections=" << t_options.connections << " sizes=" << t_options.sizes << " depth=" << t_options.depth
+		<< " threads=" << t_options.serverThreads << "/" << t_options.clientThreads << " model=" << t_options.model << " api=" << t_options.api << " backend=" << net::IO_BACKEND_NAME << std::endl
+		<< "messages/s : " << t_report.messagesPerSec << std::endl
+		<< "MB/s       : " << t_report.mbPerSec << std::endl
+		<< "cpu/msg    : " << t_report.cpuNsPerMessage << " ns (server + client, system " << t_report.systemNsPerMessage << " ns)" << std::endl
+		<< "cswitch/msg: " << std::setprecision(4) << t_report.contextSwitchesPerMessage << std::setprecision(2) << std::endl
+		<< "allocs/msg : " << std::setprecision(4) << t_report.allocationsPerMessage << std::setprecision(2) << " (" << t_report.allocations << ")" << std::endl
+		<< "io time ms : spin=" << static_cast<double>(t_report.spinNs) / 1e6 << " work=" << static_cast<double>(t_report.workNs) / 1e6
+		<< " block=" << static_cast<double>(t_report.blockNs) / 1e6 << " blocks=" << t_report.blocks << std::endl
+		<< "rtt (us)   : p50=" << us(t_report.p50) << " p90=" << us(t_report.p90) << " p99=" << us(t_report.p99)
+		<< " p999=" << us(t_report.p999) << " max=" << us(t_report.max) << std::endl;
+}
+
+void PrintStages(const char* t_name, net::IController& t_controller)
+{
+	net::_latency_report_t report;
+	t_controller.GetLatencyReport(report);
+
+	for (auto& stage : report)
+	{
+		std::cout << t_name << " stage " << static_cast<int32_t>(stage.stage) << " : count=" << stage.count
+			<< " p50=" << stage.p50 << " p99=" << stage.p99 << " p999=" << stage.p999 << " max=" << stage.max << " ns" << std::endl;
+	}
+}
+
+void PrintPlacement(const char* t_name, net::IController& t_controller)
+{
+	net::_placement_list_t placements;
+	t_controller.GetPlacement(placements);
+
+	for (auto& placement : placements)
+	{
+		std::cout << t_name << " worker " << placement.index << " : cpus=" << net::CpuTopology::ToString(placement.cpus)
+			<< " node=" << placement.node << " cpu=" << placement.cpu << " pinned=" << placement.pinned << std::endl;
+	}
+}
+
+bool WriteResult(const Options& t_options, const Report& t_report)
+{
+	std::ofstream file(t_options.output);
+	if (false == file.is_open())
+	{
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(3)
+		<< "{\n"
+		<< "\t\"options\": {\n"
+		<< "\t\t\"connections\": " << t_options.connections << ",\n"
+		<< "\t\t\"sizes\": \"" << t_options.sizes << "\",\n"
+		<< "\t\t\"depth\": " << t_options.depth << ",\n"
+		<< "\t\t\"server_threads\": " << t_options.serverThreads << ",\n"
+		<< "\t\t\"client_threads\": " << t_options.clientThreads << ",\n"
+		<< "\t\t\"duration\": " << t_options.duration << ",\n"
+		<< "\t\t\"model\": \"" << t_options.model << "\",\n"
+		<< "\t\t\"api\": \"" << t_options.api << "\",\n"
+		<< "\t\t\"placement\": \"" << t_options.placement << "\",\n"
+		<< "\t\t\"spin_us\": " << t_options.spin << ",\n"
+		<< "\t\t\"busy_poll_us\": " << t_options.busyPoll << ",\n"
+		<< "\t\t\"backend\": \"" << net::IO_BACKEND_NAME << "\"\n"
+		<< "\t},\n"
+		<< "\t\"seconds\": " << t_report.seconds << ",\n"
+		<< "\t\"messages\": " << t_report.messages << ",\n"
+		<< "\t\"bytes\": " << t_report.bytes << ",\n"
+		<< "\t\"messages_per_sec\": " << t_report.messagesPerSec << ",\n"
+		<< "\t\"mb_per_sec\": " << t_report.mbPerSec << ",\n"
+		<< "\t\"cpu_ns_per_message\": " << t_report.cpuNsPerMessage << ",\n"
+		<< "\t\"system_ns_per_message\": " << t_report.systemNsPerMessage << ",\n"
+		<< "\t\"context_switches_per_message\": " << t_report.contextSwitchesPerMessage << ",\n"
+		<< "\t\"allocations\": " << t_report.allocations << ",\n"
+		<< "\t\"allocations_per_message\": " << t_report.allocationsPerMessage << ",\n"
+		<< "\t\"io_time_ns\": { \"spin\": " << t_report.spinNs << ", \"work\": " << t_report.workNs << ", \"block\": " << t_report.blockNs
+		<< ", \"blocks\": " << t_report.blocks << " },\n"
+		<< "\t\"rtt_ns\": { \"p50\": " << t_report.p50 << ", \"p90\": " << t_report.p90 << ", \"p99\": " << t_report.p99
+		<< ", \"p999\": " << t_report.p999 << ", \"max\": " << t_report.max << " }\n"
+		<< "}\n";
+
+	return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	bench::Options options;
+	if (false == bench::ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	bench::SizeDistribution sizes;
+	if (false == sizes.Parse(options.sizes))
+	{
+		std::cout << "invalid sizes: " << options.sizes << std::endl;
+		return 1;
+	}
+
+	net::eIoModel ioModel = ("shared" == options.model) ? net::eIoModel::SHARED : net::eIoModel::PER_THREAD;
+
+	net::eCpuPlacement placement = net::eCpuPlacement::NONE;
+	if ("core" == options.placement) placement = net::eCpuPlacement::CORE;
+	else if ("numa" == options.placement) placement = net::eCpuPlacement::NUMA;
+	else if ("none" != options.placement)
+	{
+		std::cout << "invalid placement: " << options.placement << std::endl;
+		return 1;
+	}
+
+	// 서버와 클라이언트가 같은 CPU에 겹치지 않도록 이어서 배정한다.
+	std::vector<net::_cpu_list_t> serverCpuSets = net::CpuTopology::Instance().Place(placement, options.serverThreads + options.clientThreads);
+	std::vector<net::_cpu_list_t> clientCpuSets;
+	if (false == serverCpuSets.empty())
+	{
+		clientCpuSets.assign(serverCpuSets.begin() + options.serverThreads, serverCpuSets.end());
+		serverCpuSets.resize(options.serverThreads);
+	}
+
+	bench::Configuration serverConfiguration(options.port, ioModel, std::move(serverCpuSets), options.spin, options.busyPoll);
+	bench::Configuration clientConfiguration(options.port, ioModel, std::move(clientCpuSets), options.spin, options.busyPoll);
+	serverConfiguration.AllowFrameLength(sizes.GetMax());
+	clientConfiguration.AllowFrameLength(sizes.GetMax());
+
+	bench::EchoServer server(options.serverThreads, serverConfiguration, "coroutine" == options.api);
+	if (false == server.GetController().Accept())
+	{
+		std::cout << "failed to listen. port=" << options.port << std::endl;
+		return 1;
+	}
+
+	bench::EchoClient client(options.clientThreads, clientConfiguration, sizes);
+
+	std::vector<net::_sid_t> sids;
+	for (uint32_t i = 0; i < options.connections; ++i)
+	{
+		net::_sid_t sid = client.GetController().Connect();
+		if (0 >= sid)
+		{
+			std::cout << "failed to connect." << std::endl;
+			return 1;
+		}
+		sids.push_back(sid);
+	}
+
+	auto deadline = bench::_clock_t::now() + std::chrono::seconds(10);
+	while (options.connections > client.GetConnected())
+	{
+		if (bench::_clock_t::now() > deadline)
+		{
+			std::cout << "connect timeout. connected=" << client.GetConnected() << std::endl;
+			return 1;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	for (auto& sid : sids)
+	{
+		for (uint32_t i = 0; i < options.depth; ++i)
+		{
+			client.Send(sid);
+		}
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.warmup));
+
+	// 측정
+	client.SetMeasuring(true);
+	net::Throughput ioBegin = bench::GetIoTime(server.GetController(), client.GetController());
+	bench::CpuUsage cpuBegin = bench::GetProcessCpuUsage();
+	uint64_t allocationBegin = bench::GetAllocationCounter().load(std::memory_order_relaxed);
+	auto begin = bench::_clock_t::now();
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.duration));
+
+	client.SetMeasuring(false);
+	uint64_t allocationEnd = bench::GetAllocationCounter().load(std::memory_order_relaxed);
+	bench::CpuUsage cpuEnd = bench::GetProcessCpuUsage();
+	net::Throughput ioEnd = bench::GetIoTime(server.GetController(), client.GetController());
+	auto end = bench::_clock_t::now();
+
+	client.Stop();
+
+	auto latency = std::make_unique<net::LatencyHistogram>();
+	bench::Report report;
+	client.Merge(*latency, report.messages, report.bytes);
+
+	report.seconds = std::chrono::duration<double>(end - begin).count();
+	report.messagesPerSec = static_cast<double>(report.messages) / report.seconds;
+	report.mbPerSec = static_cast<double>(report.bytes) / (1024.0 * 1024.0) / report.seconds;
+	report.allocations = allocationEnd - allocationBegin;
+	report.spinNs = ioEnd.spinTime - ioBegin.spinTime;
+	report.workNs = ioEnd.workTime - ioBegin.workTime;
+	report.blockNs = ioEnd.blockTime - ioBegin.blockTime;
+	report.blocks = ioEnd.blocks - ioBegin.blocks;
+	if (0 < report.messages)
+	{
+		double messages = static_cast<double>(report.messages);
+		report.cpuNsPerMessage = static_cast<double>((cpuEnd.user + cpuEnd.system) - (cpuBegin.user + cpuBegin.system)) / messages;
+		report.systemNsPerMessage = static_cast<double>(cpuEnd.system - cpuBegin.system) / messages;
+		report.contextSwitchesPerMessage = static_cast<double>(cpuEnd.contextSwitches - cpuBegin.contextSwitches) / messages;
+		report.allocationsPerMessage = static_cast<double>(report.allocations) / messages;
+	}
+	report.p50 = latency->GetPercentile(50.0);
+	report.p90 = latency->GetPercentile(90.0);
+	report.p99 = latency->GetPercentile(99.0);
+	report.p999 = latency->GetPercentile(99.9);
+	report.max = latency->GetMax();
+
+	// 남은 에코가 끝날 때까지 기다린다.
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	bench::Print(options, report);
+	bench::PrintStages("server", server.GetController());
+	bench::PrintStages("client", client.GetController());
+	bench::PrintPlacement("server", server.GetController());
+	bench::PrintPlacement("client", client.GetController());
+
+	client.GetController().Stop();
+	server.GetController().Stop();
+
+	if (false == bench::WriteResult(options, report))
+	{
+		std::cout << "failed to write result. file=" << options.output << std::endl;
+		return 1;
+	}
+
+	std::cout << "result : " << options.output << std::endl;
+
+	// 정상 상태(예열 이후)의 송수신 경로는 힙 할당이 없어야 한다.
+	if (true == options.zeroAlloc && 0 < report.allocations)
+	{
+		std::cout << "heap allocations in steady state. allocations=" << report.allocations << std::endl;
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include "net_interface.h"
+
+// 컴파일할 최소 로그 레벨(0 : TRACE ~ 4 : ERR, 이보다 낮은 레벨의 로그는 코드가 생성되지 않는다.)
+#ifndef _NET_LOG_LEVEL
+#define _NET_LOG_LEVEL 0
+#endif
+
+namespace net
+{
+constexpr eLogLevel COMPILED_LOG_LEVEL = static_cast<eLogLevel>(_NET_LOG_LEVEL);
+
+// 로그 레코드(128byte 고정 크기)
+// - 문자열은 포맷하지 않고 그대로 복사하며, 에러 코드는 값과 category만 기록한다.
+// - MESSAGE_SIZE보다 긴 메시지는 뒤의 레코드에 이어서 기록한다.(continued)
+struct LogRecord
+{
+	static constexpr std::size_t SIZE = 128;
+	static constexpr std::size_t MESSAGE_SIZE = 80;
+
+	uint64_t time = 0;	// system_clock(ns)
+	ILogging* sink = nullptr;
+	const char* function = nullptr;	// 정적 문자열(__FUNCTION__)만 사용한다.
+	const boost::system::error_category* category = nullptr;	// nullptr이면 에러 코드 없음
+	int32_t line = 0;
+	int32_t errorValue = 0;
+	uint32_t dropped = 0;	// 이 레코드 앞에서 링이 가득 차 버려진 로그 수
+	uint8_t level = 0;
+	uint8_t continued = 0;
+	uint16_t length = 0;
+	char message[MESSAGE_SIZE];
+};
+static_assert(LogRecord::SIZE == sizeof(LogRecord));
+
+// 비동기 로그
+// - 로그를 남기는 스레드마다 lock-free 링(단일 생산자/단일 소비자)을 두고 바이너리 레코드만 기록한다.
+// - 로그 스레드가 주기적으로 링을 비우면서 문자열을 만들어 ILogging에 전달한다.(ILogging은 로그 스레드에서만 호출된다.)
+// - 링이 가득 차면 기다리지 않고 버리며, 버린 수는 다음 로그에 함께 남긴다.
+class AsyncLogger : private boost::noncopyable
+{
+public:
+	static constexpr uint32_t RING_CAPACITY = 1024;	// 스레드당 128KB
+	static constexpr std::size_t MAX_MESSAGE_LENGTH = LogRecord::MESSAGE_SIZE * 8;
+	static constexpr std::chrono::milliseconds DRAIN_INTERVAL{ 10 };
+
+	static AsyncLogger& Instance();
+
+	// 링이 가득 찼으면 false
+	bool Write(ILogging* t_sink, const eLogLevel& t_level, const char* t_function, const int32_t t_line, const std::string_view t_message, const boost::system::error_code* t_errorCode);
+
+	// 호출 전에 기록된 모든 로그가 ILogging에 전달될 때까지 기다린다.(ILogging을 해제하기 전에 호출, ILogging 안에서 호출하면 안된다.)
+	void Flush();
+
+private:
+	struct Ring : private boost::noncopyable
+	{
+		std::array<LogRecord, RING_CAPACITY> records;
+
+		alignas(64) std::atomic<uint64_t> head{ 0 };	// 생산자
+		uint32_t dropped = 0;							// 생산자만 사용
+
+		alignas(64) std::atomic<uint64_t> tail{ 0 };	// 소비자(로그 스레드)
+		std::atomic<bool> retired{ false };				// 스레드가 종료되었다.(비운 뒤 해제)
+	};
+
+	struct ThreadRing : private boost::noncopyable
+	{
+		explicit ThreadRing(AsyncLogger& t_logger);
+		~ThreadRing();
+
+		Ring* ring = nullptr;
+	};
+
+	AsyncLogger();
+	~AsyncLogger();
+
+	Ring& GetThreadRing();
+
+	void Run();
+
+	// 링에 쌓인 레코드를 모두 ILogging에 전달한다.(로그 스레드)
+	void Drain(Ring& t_ring);
+	void Deliver(const LogRecord& t_record, const std::string_view t_message);
+
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::condition_variable m_flushed;
+	std::vector<Ring*> m_rings;
+	uint64_t m_flushRequested = 0;
+	uint64_t m_flushCompleted = 0;
+	bool m_stopping = false;
+
+	// 로그 스레드에서만 사용
+	std::string m_message;
+	std::string m_line;
+
+	std::thread m_thread;
+};
+
+// 로그 싱크와 런타임 레벨을 묶은 핸들
+// - 컴파일 레벨보다 낮은 로그는 if constexpr로 제거되고, 런타임 레벨 검사는 비교 한번이다.
+// - 싱크가 없으면 모든 레벨을 끈다.
+class Logger
+{
+public:
+	Logger() = default;
+
+	explicit Logger(ILogging* t_sink)
+		: m_sink(t_sink)
+		, m_level((nullptr == t_sink) ? DISABLED : static_cast<int32_t>(t_sink->GetLevel()))
+	{
+	}
+
+	template <eLogLevel Level>
+	inline bool IsEnabled() const
+	{
+		if constexpr (COMPILED_LOG_LEVEL > Level)
+		{
+			return false;
+		}
+		else
+		{
+			return (static_cast<int32_t>(Level) >= m_level);
+		}
+	}
+
+	template <eLogLevel Level>
+	inline void Write(const char* t_function, const int32_t t_line, const std::string_view t_message) const
+	{
+		if constexpr (COMPILED_LOG_LEVEL <= Level)
+		{
+			if (static_cast<int32_t>(Level) >= m_level)
+			{
+				AsyncLogger::Instance().Write(m_sink, Level, t_function, t_line, t_message, nullptr);
+			}
+		}
+	}
+
+	template <eLogLevel Level>
+	inline void Write(const char* t_function, const int32_t t_line, const boost::system::error_code& t_errorCode) const
+	{
+		if constexpr (COMPILED_LOG_LEVEL <= Level)
+		{
+			if (static_cast<int32_t>(Level) >= m_level)
+			{
+				AsyncLogger::Instance().Write(m_sink, Level, t_function, t_line, std::string_view(), &t_errorCode);
+			}
+		}
+	}
+
+private:
+	static constexpr int32_t DISABLED = static_cast<int32_t>(eLogLevel::ERR) + 1;
+
+	ILogging* m_sink = nullptr;
+	int32_t m_level = DISABLED;
+};
+}
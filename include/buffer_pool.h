@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include "net_interface.h"
+
+namespace net
+{
+// 크기별(size class) 버퍼 풀
+// - 64B ~ 64KB 사이의 2의 배수 크기로 블록을 나누고, 스레드마다 캐시(slab)를 두어 lock 없이 할당/반납한다.
+// - 스레드 캐시가 비거나 넘치면 공용 목록과 묶음 단위로 주고받는다.(io 스레드에서 반납된 블록이 앱 스레드로 돌아간다.)
+// - 공용 목록은 NUMA 노드별로 두어, 한 노드의 스레드가 처음 쓴(first touch) 블록이 다른 노드의 스레드로 넘어가지 않도록 한다.
+// - 가장 큰 크기를 넘는 요청은 풀을 거치지 않고 바로 할당한다.
+class BufferPool : private boost::noncopyable
+{
+public:
+	static constexpr uint32_t MIN_CLASS_BITS = 6;	// 64B
+	static constexpr uint32_t MAX_CLASS_BITS = 16;	// 64KB
+	static constexpr uint32_t NUMBER_OF_CLASSES = MAX_CLASS_BITS - MIN_CLASS_BITS + 1;
+	static constexpr uint32_t OVERSIZE = NUMBER_OF_CLASSES;
+
+	// 스레드 캐시가 크기별로 보관하는 최대 용량
+	static constexpr std::size_t CACHE_BYTES_PER_CLASS = 256 * 1024;
+
+	static BufferPool& Instance();
+
+	// t_size를 담을 수 있는 크기 구분(OVERSIZE일 경우 풀을 사용하지 않음)
+	static uint32_t GetClass(const std::size_t& t_size);
+
+	// 실제로 할당되는 크기
+	static std::size_t RoundUp(const std::size_t& t_size);
+
+	// 반납 시에는 할당할 때와 같은 크기(또는 RoundUp한 크기)를 전달한다.
+	void* Allocate(const std::size_t& t_size);
+	void Release(void* t_pointer, const std::size_t& t_size);
+
+	// 현재 스레드가 사용할 공용 목록의 노드를 정한다.(기본값은 스레드 캐시를 만들 때 실행 중인 CPU의 노드)
+	// io 워커가 CPU에 고정된 뒤 호출하며, 보관 중인 블록은 이전 노드의 목록으로 돌려준다.
+	void SetThreadNode(const uint32_t t_node);
+
+	void GetStats(BufferPoolStats& t_stats);
+
+private:
+	using _block_list_t = std::vector<void*>;
+
+	struct ThreadCache : private boost::noncopyable
+	{
+		explicit ThreadCache(BufferPool& t_pool);
+		~ThreadCache();
+
+		BufferPool& pool;
+		std::array<_block_list_t, NUMBER_OF_CLASSES> blocks;
+		uint32_t node = 0;
+
+		// 자신의 스레드에서만 갱신한다.
+		std::atomic<uint64_t> hits{ 0 };
+		std::atomic<uint64_t> misses{ 0 };
+	};
+
+	struct alignas(64) Central
+	{
+		std::mutex mutex;
+		_block_list_t blocks;
+	};
+
+	using _central_list_t = std::array<Central, NUMBER_OF_CLASSES>;
+
+	BufferPool();
+	~BufferPool();
+
+	static inline std::size_t GetClassSize(const uint32_t t_class)
+	{
+		return std::size_t(1) << (t_class + MIN_CLASS_BITS);
+	}
+
+	// 스레드 캐시가 보관할 최대 블록 수
+	static inline std::size_t GetCacheLimit(const uint32_t t_class)
+	{
+		return std::max<std::size_t>(CACHE_BYTES_PER_CLASS / GetClassSize(t_class), 4);
+	}
+
+	ThreadCache& GetThreadCache();
+
+	// 공용 목록에서 최대 t_count개를 가져온다.
+	void Refill(ThreadCache& t_cache, const uint32_t t_class, const std::size_t t_count);
+
+	// 스레드 캐시에서 t_count개를 공용 목록으로 돌려준다.
+	void Flush(ThreadCache& t_cache, const uint32_t t_class, const std::size_t t_count);
+
+	void Register(ThreadCache* t_cache);
+	void Unregister(ThreadCache* t_cache);
+
+	// 노드별 공용 목록
+	std::vector<_central_list_t> m_centrals;
+
+	std::mutex m_mutex;
+	std::vector<ThreadCache*> m_threadCaches;
+
+	// 종료된 스레드의 통계
+	uint64_t m_retiredHits = 0;
+	uint64_t m_retiredMisses = 0;
+};
+
+// allocate_shared로 shared_ptr의 제어 블록까지 풀에서 할당하기 위한 할당자
+template <typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	PoolAllocator() = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&)
+	{
+	}
+
+	T* allocate(std::size_t t_n)
+	{
+		return static_cast<T*>(BufferPool::Instance().Allocate(sizeof(T) * t_n));
+	}
+
+	void deallocate(T* t_pointer, std::size_t t_n)
+	{
+		BufferPool::Instance().Release(t_pointer, sizeof(T) * t_n);
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const { return true; }
+
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+// 풀에서 미리 크기를 맞춰 할당한 쓰기 버퍼(WriteBufferImpl과 같이 앞 4byte에 길이를 기록한다.)
+class PooledWriteBuffer : public IWriteBuffer, private boost::noncopyable
+{
+public:
+	static constexpr std::size_t RESERVED_SPACE_SIZE = sizeof(int32_t);
+
+	// t_capacity : 길이 헤더를 제외한 데이터 크기
+	explicit PooledWriteBuffer(const std::size_t& t_capacity);
+	virtual ~PooledWriteBuffer();
+
+	virtual bool IsEmpty() override
+	{
+		return (RESERVED_SPACE_SIZE == m_offset);
+	}
+
+	virtual const uint8_t* GetData() override
+	{
+		return m_pointer;
+	}
+
+	virtual size_t GetLength() override
+	{
+		return m_offset;
+	}
+
+	virtual size_t Put(const void* t_data, const size_t& t_length) override;
+	virtual void Commit() override;
+
+	inline std::size_t GetCapacity() const { return m_capacity; }
+
+private:
+	void Grow(const std::size_t& t_length);
+
+	std::size_t m_capacity = 0;
+	std::size_t m_offset = RESERVED_SPACE_SIZE;
+	uint8_t* m_pointer = nullptr;
+};
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include "net_interface.h"
+#include "buffer_pool.h"
+
+namespace net
+{
+class CoSession;
+class CoListener;
+
+// 세션 코루틴 반환 타입
+// - 바로 실행되고 결과를 돌려주지 않는다.(끝나면 프레임이 스스로 해제된다.)
+// - 프레임은 BufferPool에서 할당한다.
+// - 세션 콜백과 같은 io 스레드(실행기)에서 재개되므로 CoSession의 awaiter만 co_await 한다.
+class CoTask
+{
+public:
+	struct promise_type
+	{
+		explicit promise_type(CoSession& t_session);
+
+		// 멤버 함수 코루틴도 허용한다.
+		template <typename Owner>
+		promise_type(Owner&, CoSession& t_session)
+			: promise_type(t_session)
+		{
+		}
+
+		~promise_type();
+
+		static void* operator new(std::size_t t_size)
+		{
+			return BufferPool::Instance().Allocate(t_size);
+		}
+
+		static void operator delete(void* t_pointer, std::size_t t_size)
+		{
+			BufferPool::Instance().Release(t_pointer, t_size);
+		}
+
+		CoTask get_return_object() { return CoTask(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+
+		CoSession& session;
+	};
+};
+
+// ReadMessage 결과(연결이 끊어지면 errorCode가 설정되고 data는 비어 있다.)
+struct CoMessage
+{
+	std::span<const uint8_t> data;
+	boost::system::error_code errorCode;
+
+	explicit operator bool() const { return !errorCode; }
+};
+
+// 코루틴에서 사용하는 세션 핸들
+// - ReadMessage로 받은 데이터는 다음 co_await 전까지만 유효하다.(OnMessage와 같이 수신 버퍼를 그대로 가리킬 수 있다.)
+// - 코루틴이 메시지를 기다리는 중이면 복사 없이 OnMessage 안에서 바로 재개하고, 다른 일을 하는 중이면 복사하여 쌓아 둔다.
+// - 쌓인 메시지가 MAX_PENDING_MESSAGES에 도달하면 수신을 멈추고, 모두 꺼내면 다시 시작한다.
+// - Write는 WOULD_BLOCK일 경우 OnWritable까지 기다렸다가 다시 쓴다.
+class CoSession : private boost::noncopyable
+{
+public:
+	static constexpr std::size_t MAX_PENDING_MESSAGES = 64;
+
+	class ReadAwaiter
+	{
+	public:
+		explicit ReadAwaiter(CoSession& t_session) : m_session(t_session) {}
+
+		bool await_ready() const { return m_session.IsReadable(); }
+		void await_suspend(std::coroutine_handle<> t_handle) { m_session.m_reader = t_handle; }
+		CoMessage await_resume() { return m_session.TakeMessage(); }
+
+	private:
+		CoSession& m_session;
+	};
+
+	class WriteAwaiter
+	{
+	public:
+		WriteAwaiter(CoSession& t_session, _write_buffer_ptr_t& t_buffer) : m_session(t_session), m_buffer(t_buffer) {}
+
+		bool await_ready() { return false; }
+		bool await_suspend(std::coroutine_handle<> t_handle);
+		eWriteResult await_resume() { return m_result; }
+
+	private:
+		CoSession& m_session;
+		_write_buffer_ptr_t& m_buffer;
+		eWriteResult m_result = eWriteResult::SUCCESS;
+	};
+
+	CoSession(const _sid_t& t_sid, IController* t_controller, CoListener* t_listener);
+	~CoSession();
+
+	inline const _sid_t& GetSid() const { return m_sid; }
+	inline bool IsClosed() const { return m_closed; }
+
+	ReadAwaiter ReadMessage() { return ReadAwaiter(*this); }
+
+	// 버퍼는 SUCCESS를 반환할 때까지 유지한다.
+	WriteAwaiter Write(_write_buffer_ptr_t& t_buffer) { return WriteAwaiter(*this, t_buffer); }
+
+	inline _write_buffer_ptr_t CreateWriteBuffer(const std::size_t& t_capacity) { return m_controller->CreateWriteBuffer(t_capacity); }
+
+private:
+	friend class CoListener;
+	friend struct CoTask::promise_type;
+
+	inline bool IsReadable() const
+	{
+		return (nullptr != m_received.data() || false == m_pending.empty() || true == m_closed);
+	}
+
+	// 아래 함수는 세션의 io 스레드에서만 호출한다.
+	void OnMessage(const uint8_t* t_data, const std::size_t& t_len);
+	void OnWritable();
+	void OnClose(const boost::system::error_code& t_errorCode);
+
+	CoMessage TakeMessage();
+	void Resume(std::coroutine_handle<>& t_handle);
+
+	_sid_t m_sid = 0;
+	IController* m_controller = nullptr;
+	CoListener* m_listener = nullptr;
+
+	bool m_running = false;		// 코루틴이 끝나지 않았다.
+	bool m_closed = false;
+	bool m_readPaused = false;
+	boost::system::error_code m_closeError;
+
+	std::coroutine_handle<> m_reader;
+	std::coroutine_handle<> m_writer;
+	_write_buffer_ptr_t* m_writeBuffer = nullptr;
+	eWriteResult* m_writeResult = nullptr;
+
+	// 기다리는 코루틴에 바로 넘기는 수신 데이터(OnMessage 안에서만 유효)
+	std::span<const uint8_t> m_received;
+
+	// 코루틴이 다른 일을 하는 동안 받은 메시지(복사본)와 마지막으로 꺼낸 메시지
+	std::deque<MessageBuffer::_ptr_t> m_pending;
+	MessageBuffer::_ptr_t m_current;
+};
+
+// 세션마다 코루틴을 실행하는 IListener
+// - OnConnected에서 CoSession을 만들고 핸들러 코루틴을 시작한다.(Accept/Connect 모두)
+// - 연결이 끊어지고 코루틴이 끝나면 CoSession을 해제한다.
+// - IController::Stop으로 io 스레드를 멈춘 뒤 해제한다.(기다리던 코루틴 프레임은 재개하지 않고 해제한다.)
+class CoListener : public IListener, private boost::noncopyable
+{
+public:
+	using _handler_t = std::function<CoTask(CoSession&)>;
+
+	static constexpr uint32_t NUMBER_OF_SHARDS = 64;
+
+	CoListener(IController* t_controller, _handler_t&& t_handler);
+	virtual ~CoListener();
+
+	virtual void OnConnected(const _sid_t& sid) override;
+	virtual void OnClose(const _sid_t& sid, const boost::system::error_code& t_errorCode) override;
+	virtual void OnMessage(const _sid_t& sid, const uint8_t* data, const std::size_t& len) override;
+	virtual void OnError(const _sid_t& sid, const boost::system::error_code& t_errorCode) override;
+	virtual void OnWritable(const _sid_t& sid) override;
+
+	std::size_t GetSize();
+
+private:
+	friend struct CoTask::promise_type;
+
+	using _session_map_t = std::unordered_map<_sid_t, std::unique_ptr<CoSession>>;
+
+	struct alignas(64) Shard
+	{
+		std::mutex mutex;
+		_session_map_t sessions;
+	};
+
+	inline Shard& GetShard(const _sid_t& t_sid)
+	{
+		return m_shards[std::hash<_sid_t>()(t_sid) % NUMBER_OF_SHARDS];
+	}
+
+	CoSession* Find(const _sid_t& t_sid);
+	void Remove(const _sid_t& t_sid);
+
+	IController* m_controller = nullptr;
+	_handler_t m_handler;
+
+	std::array<Shard, NUMBER_OF_SHARDS> m_shards;
+	bool m_destroying = false;
+};
+}
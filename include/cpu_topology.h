@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include "net_interface.h"
+
+namespace net
+{
+// CPU/NUMA 구성(처음 사용할 때 한번 읽는다.)
+// - Linux : sched_getaffinity로 프로세스에 허용된 CPU를, /sys/devices/system/node로 노드별 CPU를 읽는다.
+// - Windows : 프로세서 그룹 0(64개)만 지원한다.
+// - 노드 정보를 읽을 수 없으면 허용된 CPU 전체를 노드 0 하나로 본다.
+class CpuTopology : private boost::noncopyable
+{
+public:
+	static const CpuTopology& Instance();
+
+	// 프로세스에 허용된 CPU(노드 순서)
+	inline const _cpu_list_t& GetAvailableCpus() const { return m_available; }
+
+	// 허용된 CPU가 있는 노드 번호
+	inline const std::vector<uint32_t>& GetNodes() const { return m_nodes; }
+
+	// 노드 번호 + 1(노드 번호로 배열을 만들 때 사용한다.)
+	inline uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_nodeCpus.size()); }
+
+	// 노드의 허용된 CPU
+	const _cpu_list_t& GetNodeCpus(const uint32_t t_node) const;
+
+	// CPU가 속한 노드(알 수 없으면 -1)
+	int32_t GetNode(const uint32_t t_cpu) const;
+
+	// 모든 CPU가 같은 노드에 속하면 그 노드(아니면 -1)
+	int32_t GetNode(const _cpu_list_t& t_cpus) const;
+
+	// t_count개의 워커를 배치할 CPU(NONE이면 비어 있다.)
+	std::vector<_cpu_list_t> Place(const eCpuPlacement t_placement, const uint32_t t_count) const;
+
+	// 현재 스레드를 t_cpus에 고정한다.
+	static bool SetThreadAffinity(const _cpu_list_t& t_cpus);
+
+	// 현재 스레드의 affinity(읽을 수 없으면 비어 있다.)
+	static _cpu_list_t GetThreadAffinity();
+
+	// 현재 스레드가 실행 중인 CPU(알 수 없으면 -1)
+	static int32_t GetCurrentCpu();
+
+	// "0-3,8" 형식
+	static std::string ToString(const _cpu_list_t& t_cpus);
+	static bool Parse(const std::string& t_text, _cpu_list_t& t_cpus);
+
+private:
+	CpuTopology();
+
+	_cpu_list_t m_available;
+	std::vector<uint32_t> m_nodes;
+	std::vector<_cpu_list_t> m_nodeCpus;
+	std::vector<int32_t> m_cpuNodes;	// CPU 번호 -> 노드
+};
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace net
+{
+// Epoch 기반 메모리 회수(EBR)
+// 읽기 쪽은 Guard로 현재 epoch를 알리기만 하고 lock을 잡지 않는다.
+// 쓰기 쪽은 연결을 끊은 객체를 Retire 하고, 활성 상태의 모든 읽기 스레드가 해당 epoch를 지난 뒤에 해제한다.
+class EpochDomain : private boost::noncopyable
+{
+public:
+	static constexpr uint32_t MAX_THREADS = 512;
+	static constexpr uint64_t QUIESCENT = ~0ull;
+
+	class Guard : private boost::noncopyable
+	{
+	public:
+		explicit Guard(EpochDomain& t_domain = EpochDomain::Instance())
+			: m_domain(t_domain)
+		{
+			m_domain.Enter();
+		}
+
+		~Guard()
+		{
+			m_domain.Leave();
+		}
+
+	private:
+		EpochDomain& m_domain;
+	};
+
+	static EpochDomain& Instance()
+	{
+		static EpochDomain domain;
+		return domain;
+	}
+
+	// 연결이 끊긴 시점의 epoch를 반환하고 epoch를 증가시킨다.
+	inline uint64_t Advance()
+	{
+		return m_globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	// 이 값보다 작은 epoch에 Retire된 객체는 해제해도 된다.
+	uint64_t GetSafeEpoch()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (0 < m_overflow.load(std::memory_order_relaxed))
+		{
+			return 0;
+		}
+
+		uint64_t safe = m_globalEpoch.load(std::memory_order_relaxed);
+		uint32_t used = m_used.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < used; ++i)
+		{
+			safe = std::min(safe, m_slots[i].epoch.load(std::memory_order_relaxed));
+		}
+
+		return safe;
+	}
+
+private:
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> epoch{ QUIESCENT };
+		uint32_t depth = 0;
+	};
+
+	// 스레드 종료 시 슬롯을 반납한다.
+	struct Registration
+	{
+		~Registration()
+		{
+			if (nullptr != domain && nullptr != slot)
+			{
+				domain->Release(slot);
+			}
+		}
+
+		EpochDomain* domain = nullptr;
+		Slot* slot = nullptr;
+	};
+
+	EpochDomain() = default;
+
+	inline void Enter()
+	{
+		Slot* slot = GetSlot();
+		if (nullptr == slot)
+		{
+			// 슬롯이 부족한 경우 회수를 막는 공용 카운터를 사용한다.
+			m_overflow.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return;
+		}
+
+		if (0 == slot->depth++)
+		{
+			slot->epoch.store(m_globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	inline void Leave()
+	{
+		Slot* slot = GetSlot();
+		if (nullptr == slot)
+		{
+			m_overflow.fetch_sub(1, std::memory_order_release);
+			return;
+		}
+
+		if (0 == --slot->depth)
+		{
+			slot->epoch.store(QUIESCENT, std::memory_order_release);
+		}
+	}
+
+	inline Slot* GetSlot()
+	{
+		static thread_local Registration registration;
+		if (this == registration.domain)
+		{
+			return registration.slot;
+		}
+
+		if (nullptr == registration.domain)
+		{
+			registration.domain = this;
+			registration.slot = Acquire();
+		}
+
+		return (this == registration.domain) ? registration.slot : nullptr;
+	}
+
+	Slot* Acquire()
+	{
+		std::lock_guard lock(m_mutex);
+		if (false == m_freeSlots.empty())
+		{
+			Slot* slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			return slot;
+		}
+
+		uint32_t used = m_used.load(std::memory_order_relaxed);
+		if (MAX_THREADS <= used)
+		{
+			return nullptr;
+		}
+
+		m_used.store(used + 1, std::memory_order_release);
+		return &m_slots[used];
+	}
+
+	void Release(Slot* t_slot)
+	{
+		std::lock_guard lock(m_mutex);
+		t_slot->epoch.store(QUIESCENT, std::memory_order_release);
+		t_slot->depth = 0;
+		m_freeSlots.push_back(t_slot);
+	}
+
+	alignas(64) std::atomic<uint64_t> m_globalEpoch{ 1 };
+	alignas(64) std::atomic<uint32_t> m_overflow{ 0 };
+	std::atomic<uint32_t> m_used{ 0 };
+
+	std::array<Slot, MAX_THREADS> m_slots;
+
+	std::mutex m_mutex;
+	std::vector<Slot*> m_freeSlots;
+};
+}
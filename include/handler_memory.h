@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <boost/noncopyable.hpp>
+#include <boost/asio/execution.hpp>
+#include <boost/asio/prefer.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/asio/require.hpp>
+#include "buffer_pool.h"
+
+namespace boost
+{
+namespace asio
+{
+// asio 핸들러 메모리(비동기 작업 종류별 슬롯)
+// - 슬롯이 비어 있고 크기가 맞으면 내부 저장 공간을 사용한다.
+// - 같은 슬롯의 작업이 겹치거나 크기가 넘으면 BufferPool(스레드 캐시)에서 할당하므로 정상 상태에서는 힙 할당이 없다.
+class HandlerMemory : private boost::noncopyable
+{
+public:
+	HandlerMemory(void* t_storage, const std::size_t t_size)
+		: m_storage(t_storage)
+		, m_size(t_size)
+		, m_inUse(false)
+	{
+	}
+
+	void* allocate(std::size_t t_size)
+	{
+		if (!m_inUse && t_size <= m_size)
+		{
+			m_inUse = true;
+			return m_storage;
+		}
+		else
+		{
+			return net::BufferPool::Instance().Allocate(t_size);
+		}
+	}
+
+	void deallocate(void* t_pointer, std::size_t t_size)
+	{
+		if (t_pointer == m_storage)
+		{
+			m_inUse = false;
+		}
+		else
+		{
+			net::BufferPool::Instance().Release(t_pointer, t_size);
+		}
+	}
+
+private:
+	void* m_storage;
+	std::size_t m_size;
+
+	// Whether the handler-based custom allocation storage has been used.
+	bool m_inUse;
+};
+
+// Size byte의 저장 공간을 가지는 슬롯
+template <std::size_t Size>
+class HandlerSlot : public HandlerMemory
+{
+public:
+	HandlerSlot()
+		: HandlerMemory(m_storage, Size)
+	{
+	}
+
+private:
+	// Storage space used for handler-based custom memory allocation.
+	alignas(std::max_align_t) unsigned char m_storage[Size];
+};
+
+// The allocator to be associated with the handler objects. This allocator only
+// needs to satisfy the C++11 minimal allocator requirements, plus rebind when
+// targeting C++03.
+template <typename T>
+class HandlerAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit HandlerAllocator(HandlerMemory& t_mem)
+		: m_memory(t_mem)
+	{
+	}
+
+	template <typename U>
+	HandlerAllocator(const HandlerAllocator<U>& t_other)
+		: m_memory(t_other.m_memory)
+	{
+	}
+
+	template <typename U>
+	struct rebind
+	{
+		typedef HandlerAllocator<U> other;
+	};
+
+	bool operator==(const HandlerAllocator& t_other) const
+	{
+		return &m_memory == &t_other.m_memory;
+	}
+
+	bool operator!=(const HandlerAllocator& t_other) const
+	{
+		return &m_memory != &t_other.m_memory;
+	}
+
+	T* allocate(std::size_t t_n) const
+	{
+		return static_cast<T*>(m_memory.allocate(sizeof(T) * t_n));
+	}
+
+	void deallocate(T* t_p, std::size_t t_n) const
+	{
+		return m_memory.deallocate(t_p, sizeof(T) * t_n);
+	}
+
+	//private:
+		// The underlying memory.
+	HandlerMemory& m_memory;
+};
+
+// Wrapper class template for handler objects to allow handler memory
+// allocation to be customised. The allocator_type typedef and get_allocator()
+// member function are used by the asynchronous operations to obtain the
+// allocator. Calls to operator() are forwarded to the encapsulated handler.
+template <typename Handler>
+class CustomAllocHandler
+{
+public:
+	typedef HandlerAllocator<Handler> allocator_type;
+
+	CustomAllocHandler(HandlerMemory& t_m, Handler t_h)
+		: m_memory(t_m)
+		, m_handler(std::move(t_h))
+	{
+	}
+
+	allocator_type get_allocator() const
+	{
+		return allocator_type(m_memory);
+	}
+
+	// post(인자 없음), 완료 핸들러(error, 결과) 모두 전달한다.
+	template <typename... Args>
+	void operator()(Args&&... t_args)
+	{
+		m_handler(std::forward<Args>(t_args)...);
+	}
+
+private:
+	HandlerMemory& m_memory;
+	Handler m_handler;
+};
+
+// Helper function to wrap a handler object to add custom allocation.
+template <typename Handler>
+inline CustomAllocHandler<Handler> make_custom_alloc_handler(HandlerMemory& t_m, Handler t_h)
+{
+	return CustomAllocHandler<Handler>(t_m, std::move(t_h));
+}
+
+// 핸들러 메모리를 항상 BufferPool에서 할당한다.(슬롯을 둘 객체가 io_context보다 먼저 해제되는 경우)
+template <typename Handler>
+class PoolAllocHandler
+{
+public:
+	typedef net::PoolAllocator<Handler> allocator_type;
+
+	explicit PoolAllocHandler(Handler t_h)
+		: m_handler(std::move(t_h))
+	{
+	}
+
+	allocator_type get_allocator() const
+	{
+		return allocator_type();
+	}
+
+	template <typename... Args>
+	void operator()(Args&&... t_args)
+	{
+		m_handler(std::forward<Args>(t_args)...);
+	}
+
+private:
+	Handler m_handler;
+};
+
+template <typename Handler>
+inline PoolAllocHandler<Handler> make_pool_alloc_handler(Handler t_h)
+{
+	return PoolAllocHandler<Handler>(std::move(t_h));
+}
+
+// 핸들러 메모리를 항상 Executor의 할당자(BufferPool)에서 할당하는 executor
+// asio는 작업을 넘길 때 allocator 속성을 prefer하여 executor의 할당자를 바꾼다.
+// (할당자가 없는 핸들러는 std::allocator, strand가 다시 예약하는 invoker는 recycling_allocator - 스레드 사이를 오가면 힙 할당)
+// allocator 속성만 무시하고 나머지 속성은 Executor에 그대로 전달한다.
+template <typename Executor>
+class PoolExecutor
+{
+public:
+	explicit PoolExecutor(const Executor& t_executor) noexcept
+		: m_executor(t_executor)
+	{
+	}
+
+	template <typename Property>
+	auto query(const Property& t_property) const noexcept
+		-> decltype(boost::asio::query(std::declval<const Executor&>(), t_property))
+	{
+		return boost::asio::query(m_executor, t_property);
+	}
+
+	template <typename Property>
+	auto require(const Property& t_property) const noexcept
+		-> PoolExecutor<std::decay_t<decltype(boost::asio::require(std::declval<const Executor&>(), t_property))>>
+	{
+		return PoolExecutor<std::decay_t<decltype(boost::asio::require(m_executor, t_property))>>(boost::asio::require(m_executor, t_property));
+	}
+
+	template <typename OtherAllocator>
+	PoolExecutor require(const boost::asio::execution::allocator_t<OtherAllocator>&) const noexcept
+	{
+		return *this;
+	}
+
+	template <typename Function>
+	void execute(Function&& t_function) const
+	{
+		m_executor.execute(std::forward<Function>(t_function));
+	}
+
+	bool operator==(const PoolExecutor& t_other) const noexcept
+	{
+		return m_executor == t_other.m_executor;
+	}
+
+	bool operator!=(const PoolExecutor& t_other) const noexcept
+	{
+		return m_executor != t_other.m_executor;
+	}
+
+private:
+	Executor m_executor;
+};
+} // end namespace asio
+} // end namespace boost
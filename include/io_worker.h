@@ -0,0 +1,217 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include "net_interface.h"
+#include "buffer_pool.h"
+#include "handler_memory.h"
+#include "latency_histogram.h"
+#include "timer_wheel.h"
+
+// io_uring 백엔드(NET_IO_URING)는 Asio 1.21(Boost 1.78)부터 지원한다.
+#if defined(BOOST_ASIO_HAS_IO_URING) && (BOOST_VERSION < 107800)
+#error "io_uring backend requires Boost 1.78 or later."
+#endif
+
+namespace net
+{
+// 소켓 I/O 백엔드 이름(벤치마크 결과 구분용)
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+constexpr const char* IO_BACKEND_NAME = "io_uring";
+#elif defined(BOOST_ASIO_HAS_IOCP)
+constexpr const char* IO_BACKEND_NAME = "iocp";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+constexpr const char* IO_BACKEND_NAME = "epoll";
+#else
+constexpr const char* IO_BACKEND_NAME = "reactor";
+#endif
+
+// io 스레드별 처리량 카운터
+// 자신의 스레드에서만 갱신하므로 lock 접두어 없이 relaxed load/store로 누적한다.
+struct alignas(64) ThroughputCounter
+{
+	using _counter_t = std::atomic<uint64_t>;
+
+	_counter_t sessions{ 0 };
+	_counter_t readCount{ 0 };
+	_counter_t readBytes{ 0 };
+	_counter_t readFrames{ 0 };
+	_counter_t writeCount{ 0 };
+	_counter_t writeBytes{ 0 };
+	_counter_t writeFrames{ 0 };
+	_counter_t accepts{ 0 };
+	_counter_t connects{ 0 };
+	std::array<_counter_t, static_cast<std::size_t>(eCloseReason::MAX)> closes{};
+
+	// 증감하는 값은 스레드마다 따로 누적하고 합계를 구한다.(2의 보수로 더하므로 스레드별 값은 음수일 수 있다.)
+	_counter_t writeQueueDepth{ 0 };
+	_counter_t writeQueueBytes{ 0 };
+
+	// spin 실행 시간(nsec)
+	_counter_t spinTime{ 0 };
+	_counter_t workTime{ 0 };
+	_counter_t blockTime{ 0 };
+	_counter_t blocks{ 0 };
+
+	static inline void Add(_counter_t& t_counter, const uint64_t t_value)
+	{
+		t_counter.store(t_counter.load(std::memory_order_relaxed) + t_value, std::memory_order_relaxed);
+	}
+
+	static inline void Sub(_counter_t& t_counter, const uint64_t t_value)
+	{
+		t_counter.store(t_counter.load(std::memory_order_relaxed) - t_value, std::memory_order_relaxed);
+	}
+
+	// 현재 io 스레드의 카운터(io 스레드가 아닐 경우 nullptr)
+	static ThroughputCounter* Current();
+
+	static eCloseReason GetCloseReason(const boost::system::error_code& t_errorCode);
+};
+
+// 워커 스레드 하나에 대응하는 실행 단위
+// PER_THREAD 모델에서는 io_context를 단독으로 실행하고, SHARED 모델에서는 다른 워커와 공유한다.
+class IoWorker : private boost::noncopyable
+{
+public:
+	using _io_context_t = boost::asio::io_context;
+	using _work_guard_t = boost::asio::executor_work_guard<_io_context_t::executor_type>;
+	using _timer_t = boost::asio::steady_timer;
+
+	// 핸들러 메모리를 BufferPool에서 할당하는 executor
+	// 할당자가 없는 핸들러, strand의 작업과 invoker도 std::allocator/recycling_allocator 대신 이 할당자를 사용한다.
+	using _executor_t = boost::asio::PoolExecutor<_io_context_t::basic_executor_type<PoolAllocator<void>, 0>>;
+
+	// 공유 io_context에서 세션의 핸들러를 직렬화하는 strand(any_io_executor로 감싸지 않아야 핸들러마다 할당하지 않는다.)
+	using _strand_t = boost::asio::strand<_executor_t>;
+
+	// 세션 소켓(완료 핸들러에 executor를 묶지 않으면 워커의 executor에서 실행된다.)
+	using _socket_t = boost::asio::basic_stream_socket<boost::asio::ip::tcp, _executor_t>;
+
+	// t_exclusive가 true일 경우 io_context를 이 워커의 스레드만 실행한다.
+	IoWorker(const uint32_t t_index, _io_context_t& t_ioContext, const bool t_exclusive);
+
+	inline uint32_t GetIndex() const { return m_index; }
+
+	inline _io_context_t& GetIoContext() { return m_ioContext; }
+
+	inline _executor_t GetExecutor() const
+	{
+		return _executor_t(boost::asio::require(m_ioContext.get_executor(), boost::asio::execution::allocator(PoolAllocator<void>())));
+	}
+
+	// 세션이 이 워커의 스레드에서만 실행되는지 여부(true일 경우 strand가 필요 없다.)
+	inline bool IsExclusive() const { return m_exclusive; }
+
+	inline ThroughputCounter& GetCounter() { return m_counter; }
+
+	// 이 워커에 고정된 세션의 타임아웃을 확인하는 휠
+	inline TimerWheel& GetTimerWheel() { return m_timerWheel; }
+
+	// 휠을 TimerWheel::TICK 간격으로 돌리기 시작한다.(처음 한번만 시작하며 아무 스레드에서나 호출할 수 있다.)
+	inline void StartTimerWheel()
+	{
+		if (false == m_timerWheelStarted.load(std::memory_order_relaxed) && false == m_timerWheelStarted.exchange(true, std::memory_order_acq_rel))
+		{
+			boost::asio::post(GetExecutor(), [this]() {
+				m_timerWheelStart = std::chrono::steady_clock::now() - TimerWheel::TICK * m_timerWheel.GetTick();
+				WaitTick();
+				}
+			);
+		}
+	}
+
+	// 현재 스레드의 워커(io 스레드가 아닐 경우 nullptr)
+	static inline IoWorker* Current() { return s_current; }
+
+	// 스레드를 고정할 CPU(Run 전에 설정한다, 비어 있으면 고정하지 않는다.)
+	inline void SetCpuSet(const _cpu_list_t& t_cpus) { m_requestedCpus = t_cpus; }
+
+	// 작업이 없을 때 블록하기 전에 poll을 반복할 시간(Run 전에 설정한다, 0이면 바로 블록한다.)
+	// 단독 io_context(PER_THREAD)에서만 사용한다.(SHARED 모델에서는 무시한다.)
+	inline void SetSpinTime(const std::chrono::microseconds t_spinTime) { m_spinTime = t_spinTime; }
+
+	void GetPlacement(WorkerPlacement& t_placement) const;
+
+	void Run();
+	void Stop();
+
+	void GetThroughput(Throughput& t_throughput) const;
+
+	// 현재 io 스레드의 히스토그램에 t_begin ~ t_end 시간을 기록한다.(_USE_LATENCY_HISTOGRAM이 없으면 아무것도 하지 않는다.)
+	static inline void RecordLatency([[maybe_unused]] const eLatencyStage& t_stage, [[maybe_unused]] const LatencyStamp& t_begin, [[maybe_unused]] const LatencyStamp& t_end)
+	{
+#ifdef _USE_LATENCY_HISTOGRAM
+		IoWorker* worker = Current();
+		if (nullptr != worker && t_begin.time <= t_end.time)
+		{
+			worker->m_latency[static_cast<std::size_t>(t_stage)].Record(t_end.time - t_begin.time);
+		}
+#endif
+	}
+
+	static inline void RecordLatency(const eLatencyStage& t_stage, const LatencyStamp& t_begin)
+	{
+		RecordLatency(t_stage, t_begin, LatencyStamp());
+	}
+
+	// 이 워커의 히스토그램을 t_histograms에 합친다.
+	void MergeLatency(_latency_histograms_t& t_histograms) const;
+
+private:
+	// 스레드를 고정하고 실제 배치를 기록한다.(Run에서 호출)
+	void ApplyPlacement();
+
+	// run() 대신 poll()을 반복하고, m_spinTime 동안 소켓 완료가 없으면 run_one()으로 블록한다.(단독 io_context만 사용)
+	// 핸들러 메모리는 executor의 할당자(BufferPool)를 사용하므로 호출마다 asio의 스레드별 캐시가 버려져도 할당하지 않는다.
+	void RunSpin();
+
+	// 작업 여부를 판단하는 소켓 완료 수(수신/송신/accept/connect)
+	inline uint64_t GetSpinEvents() const
+	{
+		return m_counter.readCount.load(std::memory_order_relaxed) + m_counter.writeCount.load(std::memory_order_relaxed)
+			+ m_counter.accepts.load(std::memory_order_relaxed) + m_counter.connects.load(std::memory_order_relaxed);
+	}
+
+	void WaitTick();
+	void HandleTick(const boost::system::error_code& t_errorCode);
+
+	static inline thread_local IoWorker* s_current = nullptr;
+
+	uint32_t m_index = 0;
+	bool m_exclusive = false;
+
+	_io_context_t& m_ioContext;
+
+	// 단독 io_context는 처리할 작업이 없어도 run()이 종료되지 않도록 한다.
+	std::optional<_work_guard_t> m_workGuard;
+
+	ThroughputCounter m_counter;
+
+	TimerWheel m_timerWheel;
+	_timer_t m_tickTimer;
+	std::chrono::steady_clock::time_point m_timerWheelStart;	// 휠의 0 tick 시각
+	std::atomic<bool> m_timerWheelStarted{ false };
+
+	// 배치(m_requestedCpus는 Run 전에만 변경한다.)
+	_cpu_list_t m_requestedCpus;
+	mutable std::mutex m_placementMutex;
+	_cpu_list_t m_cpus;
+	int32_t m_node = -1;
+	bool m_pinned = false;
+	std::atomic<int32_t> m_lastCpu{ -1 };	// 시작할 때와 휠의 tick마다 갱신한다.
+
+	// spin(Run 전에만 변경한다.)
+	std::chrono::microseconds m_spinTime{ 0 };
+
+#ifdef _USE_LATENCY_HISTOGRAM
+	_latency_histograms_t m_latency;
+#endif
+};
+using _io_worker_ptr_t = std::unique_ptr<IoWorker>;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include "net_interface.h"
+
+namespace net
+{
+// 로그-선형(HDR 방식) 지연 시간 히스토그램(ns)
+// - 2의 배수 구간마다 16개로 나누어 약 6% 오차로 기록한다.(16ns 미만은 정확한 값)
+// - 기록은 자신의 스레드에서만 하고(relaxed load/store), 조회 시 스레드별 히스토그램을 합친다.
+class LatencyHistogram : private boost::noncopyable
+{
+public:
+	using _clock_t = std::chrono::steady_clock;
+	using _counter_t = std::atomic<uint64_t>;
+
+	static constexpr uint32_t SUB_BUCKET_BITS = 4;
+	static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+	static constexpr uint32_t MAX_EXPONENT = 40;	// 2^40ns(약 18분) 이상은 마지막 구간에 기록한다.
+	static constexpr uint32_t NUMBER_OF_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+	static inline uint64_t Now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(_clock_t::now().time_since_epoch()).count());
+	}
+
+	static inline uint32_t GetIndex(uint64_t t_value)
+	{
+		if (SUB_BUCKETS > t_value)
+		{
+			return static_cast<uint32_t>(t_value);
+		}
+
+		t_value = std::min<uint64_t>(t_value, (1ull << MAX_EXPONENT) - 1);
+
+		uint32_t exponent = static_cast<uint32_t>(std::bit_width(t_value)) - 1;
+		uint32_t sub = static_cast<uint32_t>(t_value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+		return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+	}
+
+	// 구간의 가장 작은 값
+	static inline uint64_t GetLowerBound(const uint32_t t_index)
+	{
+		if (SUB_BUCKETS > t_index)
+		{
+			return t_index;
+		}
+
+		uint32_t exponent = t_index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+		uint64_t sub = t_index & (SUB_BUCKETS - 1);
+		return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+	}
+
+	// 구간의 가장 큰 값
+	static inline uint64_t GetUpperBound(const uint32_t t_index)
+	{
+		if (NUMBER_OF_BUCKETS - 1 <= t_index)
+		{
+			return (1ull << MAX_EXPONENT) - 1;
+		}
+
+		return GetLowerBound(t_index + 1) - 1;
+	}
+
+	// 자신의 스레드에서만 호출한다.
+	inline void Record(const uint64_t t_value)
+	{
+		Add(m_counts[GetIndex(t_value)], 1);
+		Add(m_total, 1);
+	}
+
+	void Merge(const LatencyHistogram& t_other)
+	{
+		for (uint32_t i = 0; i < NUMBER_OF_BUCKETS; ++i)
+		{
+			uint64_t count = t_other.m_counts[i].load(std::memory_order_relaxed);
+			if (0 < count)
+			{
+				m_counts[i].fetch_add(count, std::memory_order_relaxed);
+			}
+		}
+		m_total.fetch_add(t_other.m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	inline uint64_t GetCount() const
+	{
+		return m_total.load(std::memory_order_relaxed);
+	}
+
+	// t_percentile(0 ~ 100) 위치의 값(구간의 가장 큰 값)
+	uint64_t GetPercentile(const double t_percentile) const
+	{
+		uint64_t total = GetCount();
+		if (0 == total)
+		{
+			return 0;
+		}
+
+		uint64_t target = static_cast<uint64_t>(t_percentile / 100.0 * static_cast<double>(total) + 0.5);
+		target = std::max<uint64_t>(target, 1);
+
+		uint64_t count = 0;
+		for (uint32_t i = 0; i < NUMBER_OF_BUCKETS; ++i)
+		{
+			count += m_counts[i].load(std::memory_order_relaxed);
+			if (target <= count)
+			{
+				return GetUpperBound(i);
+			}
+		}
+
+		return GetUpperBound(NUMBER_OF_BUCKETS - 1);
+	}
+
+	uint64_t GetMax() const
+	{
+		for (uint32_t i = NUMBER_OF_BUCKETS; 0 < i; --i)
+		{
+			if (0 < m_counts[i - 1].load(std::memory_order_relaxed))
+			{
+				return GetUpperBound(i - 1);
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	static inline void Add(_counter_t& t_counter, const uint64_t t_value)
+	{
+		t_counter.store(t_counter.load(std::memory_order_relaxed) + t_value, std::memory_order_relaxed);
+	}
+
+	std::array<_counter_t, NUMBER_OF_BUCKETS> m_counts{};
+	_counter_t m_total{ 0 };
+};
+using _latency_histograms_t = std::array<LatencyHistogram, static_cast<std::size_t>(eLatencyStage::MAX)>;
+
+// 구간 시작 시각(_USE_LATENCY_HISTOGRAM이 정의되지 않으면 빈 구조체로 아무 비용이 없다.)
+struct LatencyStamp
+{
+#ifdef _USE_LATENCY_HISTOGRAM
+	uint64_t time = LatencyHistogram::Now();
+#endif
+};
+}
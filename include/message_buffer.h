@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace net
+{
+// 참조 카운트를 가지는 메시지 버퍼
+// IListener::OnMessage로 전달되는 데이터는 수신 버퍼를 그대로 가리키므로 콜백이 끝나면 사용할 수 없다.
+// 메시지를 보관해야 하는 경우에만 Copy로 핸들을 만든다.(헤더와 데이터를 한번에 할당)
+class MessageBuffer : private boost::noncopyable
+{
+public:
+	using _ptr_t = boost::intrusive_ptr<MessageBuffer>;
+
+	// t_length 크기의 버퍼를 할당한다.(데이터는 초기화하지 않음)
+	static _ptr_t Create(const std::size_t& t_length)
+	{
+		void* memory = ::operator new(sizeof(MessageBuffer) + t_length);
+		return _ptr_t(new (memory) MessageBuffer(t_length));
+	}
+
+	static _ptr_t Copy(const uint8_t* t_data, const std::size_t& t_length)
+	{
+		_ptr_t buffer = Create(t_length);
+		if (0 < t_length)
+		{
+			memcpy(buffer->GetData(), t_data, t_length);
+		}
+		return buffer;
+	}
+
+	inline uint8_t* GetData() { return reinterpret_cast<uint8_t*>(this + 1); }
+	inline const uint8_t* GetData() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+
+	inline std::size_t GetLength() const { return m_length; }
+
+	friend inline void intrusive_ptr_add_ref(MessageBuffer* t_buffer)
+	{
+		t_buffer->m_refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	friend inline void intrusive_ptr_release(MessageBuffer* t_buffer)
+	{
+		if (1 == t_buffer->m_refCount.fetch_sub(1, std::memory_order_acq_rel))
+		{
+			t_buffer->~MessageBuffer();
+			::operator delete(t_buffer);
+		}
+	}
+
+private:
+	explicit MessageBuffer(const std::size_t& t_length)
+		: m_length(t_length)
+	{
+	}
+
+	~MessageBuffer() = default;
+
+	std::atomic<uint32_t> m_refCount{ 0 };
+	std::size_t m_length = 0;
+};
+using _message_ptr_t = MessageBuffer::_ptr_t;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <utility>
+#include <boost/noncopyable.hpp>
+#include "buffer_pool.h"
+
+namespace net
+{
+// 여러 스레드가 넣고 하나의 스레드만 꺼내는 무잠금 큐(Vyukov MPSC)
+// - Push는 exchange 한번으로 끝나므로 생산자끼리 경쟁하지 않는다.
+// - 크기 제한이 없어 io 스레드끼리 서로의 큐가 가득 차서 대기하는 일이 없고, 생산자별 순서가 유지된다.
+// - 노드는 BufferPool에서 할당하므로 풀이 채워진 뒤에는 힙 할당이 없다.
+// - 생산자가 노드를 연결하는 중에는 Pop이 비어 있다고 판단할 수 있으므로, 생산자는 Push 이후에 소비자를 깨워야 한다.
+template <typename T>
+class MpscQueue : private boost::noncopyable
+{
+	struct Node
+	{
+		std::atomic<Node*> next{ nullptr };
+		T value;
+	};
+
+public:
+	MpscQueue()
+		: m_head(CreateNode())
+		, m_tail(m_head.load(std::memory_order_relaxed))
+	{
+	}
+
+	~MpscQueue()
+	{
+		T value;
+		while (true == Pop(value))
+		{
+		}
+
+		DestroyNode(m_tail);
+	}
+
+	// 생산자(모든 스레드)
+	void Push(T&& t_value)
+	{
+		Node* node = CreateNode();
+		node->value = std::move(t_value);
+
+		Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	// 소비자(하나의 스레드)
+	bool Pop(T& t_value)
+	{
+		Node* tail = m_tail;
+		Node* next = tail->next.load(std::memory_order_acquire);
+		if (nullptr == next)
+		{
+			return false;
+		}
+
+		// 꺼낸 노드는 다음 빈 노드(stub)로 사용한다.
+		t_value = std::move(next->value);
+		next->value = T();
+		m_tail = next;
+
+		DestroyNode(tail);
+		return true;
+	}
+
+private:
+	static Node* CreateNode()
+	{
+		return new (BufferPool::Instance().Allocate(sizeof(Node))) Node;
+	}
+
+	static void DestroyNode(Node* t_node)
+	{
+		t_node->~Node();
+		BufferPool::Instance().Release(t_node, sizeof(Node));
+	}
+
+	alignas(64) std::atomic<Node*> m_head;
+	alignas(64) Node* m_tail;
+};
+}
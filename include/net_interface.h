@@ -1,9 +1,35 @@
 #pragma once
 
+#include <array>
+#include <span>
 #include "net_define.h"
+#include "message_buffer.h"
 
 namespace net
 {
+// io 실행 모델
+// SHARED : 하나의 io_context를 모든 워커 스레드가 공유한다.(세션별 strand 사용)
+// PER_THREAD : 워커 스레드마다 io_context를 두고 세션을 하나의 스레드에 고정한다.(strand 불필요)
+enum class eIoModel
+{
+	SHARED = 0,
+	PER_THREAD,
+};
+
+// io 스레드 배치(IConfiguration::WorkerCpuSets가 없을 경우 사용 가능한 CPU에 자동으로 배치한다.)
+// NONE : 고정하지 않는다.
+// CORE : 워커마다 사용 가능한 CPU 하나씩 차례대로 고정한다.
+// NUMA : 워커를 NUMA 노드에 번갈아 배정하고, 노드의 CPU 전체에 고정한다.(노드 안에서의 이동은 스케줄러에 맡긴다.)
+enum class eCpuPlacement
+{
+	NONE = 0,
+	CORE,
+	NUMA,
+};
+
+// CPU 번호 목록
+using _cpu_list_t = std::vector<uint32_t>;
+
 class IConfiguration
 {
 public:
@@ -12,6 +38,9 @@ public:
 	using _lingeropt_t = std::optional<std::pair<bool, int32_t>>;
 	using _boolopt_t = std::optional<bool>;
 	using _sizeopt_t = std::optional<int32_t>;
+	using _iomodelopt_t = std::optional<eIoModel>;
+	using _placementopt_t = std::optional<eCpuPlacement>;
+	using _cpusetsopt_t = std::optional<std::vector<_cpu_list_t>>;
 
 	// 접속 정보
 	virtual _address_t GetAddress() = 0;
@@ -23,12 +52,73 @@ public:
 	virtual _boolopt_t Nagle() = 0;
 	virtual _boolopt_t Keepalive() = 0;
 
+	// 확장 Socket 옵션(nullopt일 경우 적용하지 않는다, 지원하지 않는 플랫폼에서는 적용 결과에 실패로 기록된다.)
+	// QuickAck : TCP_QUICKACK(지연 ACK 끄기), NotSentLowat : TCP_NOTSENT_LOWAT(커널에 쌓아둘 미전송 데이터 상한, byte)
+	// ReceiveBufferSize/SendBufferSize : SO_RCVBUF/SO_SNDBUF(byte), BusyPoll : SO_BUSY_POLL(usec)
+	// Backlog : 리슨 대기열 크기(nullopt일 경우 시스템 최대값)
+	virtual _boolopt_t QuickAck() { return std::nullopt; }
+	virtual _sizeopt_t NotSentLowat() { return std::nullopt; }
+	virtual _sizeopt_t ReceiveBufferSize() { return std::nullopt; }
+	virtual _sizeopt_t SendBufferSize() { return std::nullopt; }
+	virtual _sizeopt_t BusyPoll() { return std::nullopt; }
+	virtual _sizeopt_t Backlog() { return std::nullopt; }
+
+	// 실행 옵션(nullopt일 경우 기본값을 사용한다.)
+	// SpinTime : io 스레드가 처리할 작업이 없을 때 블록하기 전에 poll을 반복하는 시간(usec, 0이면 바로 블록한다.)
+	//            epoll_wait에서 깨어나는 지연 대신 CPU를 사용하며, BusyPoll(SO_BUSY_POLL)과 함께 사용하면 커널도 수신을 기다리며 spin한다.
+	//            PER_THREAD 모델에서만 사용한다.
+	virtual _iomodelopt_t IoModel() { return std::nullopt; }
+	virtual _sizeopt_t SpinTime() { return std::nullopt; }
+
+	// Accept 옵션
+	// ReusePort : 워커마다 SO_REUSEPORT 리슨 소켓을 열어 커널이 연결을 분배하도록 한다.(지원하지 않는 플랫폼에서는 무시)
+	// PendingAccepts : 리슨 소켓마다 동시에 걸어둘 async_accept 개수(기본 1)
+	virtual _boolopt_t ReusePort() { return std::nullopt; }
+	virtual _sizeopt_t PendingAccepts() { return std::nullopt; }
+
+	// 쓰기 대기 한도(세션별 기본값, nullopt일 경우 제한하지 않는다.)
+	// WriteHighWatermark : 쓰기 대기 크기가 이 값 이상이면 Write가 WOULD_BLOCK을 반환한다.(byte)
+	// WriteLowWatermark : 막힌 세션의 대기 크기가 이 값 이하로 줄면 OnWritable을 호출한다.(byte, 기본값 high / 2)
+	// WriteBlockTimeout : 대기 크기가 high 이상인 상태가 이 시간 이상 이어지면 연결을 끊는다.(msec)
+	virtual _sizeopt_t WriteHighWatermark() { return std::nullopt; }
+	virtual _sizeopt_t WriteLowWatermark() { return std::nullopt; }
+	virtual _sizeopt_t WriteBlockTimeout() { return std::nullopt; }
+
+	// 수신 흐름 제어(nullopt일 경우 사용하지 않는다.)
+	// ReadBudget : OnMessage로 전달한 뒤 IController::AckMessages로 처리 완료를 알리지 않은 메시지 수가 이 값에 도달하면 수신을 멈춘다.
+	// MaxFrameLength : 받을 수 있는 프레임의 최대 데이터 크기(byte, nullopt이거나 0 이하일 경우 1MB), 길이가 이 값보다 크면 연결을 끊는다.(PROTOCOL)
+	virtual _sizeopt_t ReadBudget() { return std::nullopt; }
+	virtual _sizeopt_t MaxFrameLength() { return std::nullopt; }
+
+	// 연결 확인(msec, nullopt일 경우 사용하지 않는다, io 워커별 타이밍 휠로 확인하므로 TimerWheel::TICK 단위로 올림된다.)
+	// ReadIdleTimeout : 이 시간 동안 아무것도 받지 못하면 연결을 끊는다.(수신을 멈춘 동안은 재지 않는다.)
+	// WriteStallTimeout : 시작한 async_write가 이 시간 안에 끝나지 않으면 연결을 끊는다.
+	// HeartbeatInterval : 이 간격으로 ping 제어 프레임을 보낸다.(상대방의 pong으로 RTT를 추정하므로 양쪽 모두 이 라이브러리를 사용해야 한다.)
+	virtual _sizeopt_t ReadIdleTimeout() { return std::nullopt; }
+	virtual _sizeopt_t WriteStallTimeout() { return std::nullopt; }
+	virtual _sizeopt_t HeartbeatInterval() { return std::nullopt; }
+
+	// 세션 풀(io 워커별, 둘 다 nullopt일 경우 사용하지 않고 연결마다 세션을 새로 만든다.)
+	// SessionPoolSize : Accept/Connect를 처음 호출할 때 미리 만들어 둘 세션 수
+	// SessionPoolCapacity : 닫힌 세션을 초기화하여 보관할 최대 수(기본값 SessionPoolSize)
+	virtual _sizeopt_t SessionPoolSize() { return std::nullopt; }
+	virtual _sizeopt_t SessionPoolCapacity() { return std::nullopt; }
+
+	// io 스레드 배치(nullopt일 경우 고정하지 않는다, 적용 결과는 IController::GetPlacement로 확인한다.)
+	// WorkerCpuSets : 워커 i를 [i % size]의 CPU에 고정한다.(비어 있는 항목은 고정하지 않음, CpuPlacement보다 우선한다.)
+	// CpuPlacement : 프로세스에 허용된 CPU에 자동으로 배치한다.
+	// 고정한 워커는 세션 풀을 자신의 스레드에서 미리 만들고, 버퍼 풀도 노드별로 나누어 세션 메모리가 워커의 노드에 놓이도록 한다.(first touch)
+	virtual _cpusetsopt_t WorkerCpuSets() { return std::nullopt; }
+	virtual _placementopt_t CpuPlacement() { return std::nullopt; }
+
 	//
 };
 
 class IWriteBuffer
 {
 public:
+	virtual ~IWriteBuffer() = default;
+
 	virtual bool IsEmpty() = 0;
 	virtual const uint8_t* GetData() = 0;
 	virtual size_t GetLength() = 0;
@@ -43,8 +133,11 @@ class IListener
 public:
 	virtual void OnConnected(const _sid_t& sid) = 0;
 	virtual void OnClose(const _sid_t& sid, const boost::system::error_code& t_errorCode) = 0;
+	// data는 수신 버퍼를 직접 가리키며 콜백 안에서만 유효하다.(보관이 필요하면 MessageBuffer::Copy 사용)
 	virtual void OnMessage(const _sid_t& sid, const uint8_t* data, const std::size_t& len) = 0;
 	virtual void OnError(const _sid_t& sid, const boost::system::error_code& t_errorCode) = 0;
+	// WOULD_BLOCK 이후 쓰기 대기 크기가 low watermark 이하로 줄었다.(io 스레드에서 호출)
+	virtual void OnWritable(const _sid_t& /*sid*/) {}
 };
 using _listener_ptr_t = std::shared_ptr<IListener>;
 
@@ -57,9 +150,13 @@ enum class eLogLevel
 	ERR = 4,
 };
 
+// 로그 스레드에서 호출된다.(io 스레드는 레코드만 남긴다.)
 class ILogging
 {
 public:
+	// 전달받을 최소 레벨(AttachLogging 시점에 읽는다.)
+	virtual eLogLevel GetLevel() { return eLogLevel::TRACE; }
+
 	virtual void Trace(const std::string_view message) = 0;
 	virtual void Debug(const std::string_view message) = 0;
 	virtual void Info(const std::string_view message) = 0;
@@ -68,16 +165,18 @@ public:
 };
 using _logging_ptr_t = std::shared_ptr<ILogging>;
 
+// io 스레드에서 호출되므로 가볍게 처리해야 한다.(집계된 통계는 IController::Snapshot 사용)
 class IMonitor
 {
-	// 송신 요청
-	virtual void OnSend() = 0;
+public:
+	// 송신 요청(쓰기 대기 큐에 추가)
+	virtual void OnSend(const _sid_t& sid, const std::size_t& len) = 0;
 
 	// 송신 완료
-	virtual void OnSent() = 0;
+	virtual void OnSent(const _sid_t& sid, const std::size_t& len) = 0;
 
 	// 수신
-	virtual void OnReceive() = 0;
+	virtual void OnReceive(const _sid_t& sid, const std::size_t& len) = 0;
 };
 
 // 네트워크 기능을 이용하기 위한 기본 기능을 제공합니다.
@@ -90,6 +189,165 @@ enum class eState
 	CLOSED
 };
 
+// 연결 종료 사유 분류
+enum class eCloseReason
+{
+	NORMAL = 0,		// 정상 종료, 상대방 종료(eof)
+	RESET,			// connection_reset, broken_pipe 등
+	ABORTED,		// 취소
+	TIMEOUT,
+	PROTOCOL,		// 잘못된 메시지
+	OTHER,
+	MAX,
+};
+
+// io 스레드별 처리량(부하 분산 확인용)
+// readCount/writeCount는 recv/send 완료 횟수, readFrames/writeFrames는 메시지 수
+// writeQueueDepth/writeQueueBytes는 쓰기 대기 중인 메시지 수와 크기(SHARED 모델에서는 전체 합계만 의미가 있다.)
+// spinTime/workTime/blockTime은 SpinTime을 사용할 경우의 실행 시간(nsec)
+// - spinTime : 소켓 완료 없이 poll을 반복한 시간, workTime : 소켓 완료(수신/송신/accept/connect)를 처리한 시간
+// - blockTime : 블록해서 기다린 시간(깨어나서 처리한 첫 작업 포함), blocks : spin 시간 안에 작업이 없어 블록한 횟수
+struct Throughput
+{
+	uint32_t index = 0;
+	uint64_t sessions = 0;
+	uint64_t readCount = 0;
+	uint64_t readBytes = 0;
+	uint64_t readFrames = 0;
+	uint64_t writeCount = 0;
+	uint64_t writeBytes = 0;
+	uint64_t writeFrames = 0;
+	uint64_t accepts = 0;
+	uint64_t connects = 0;
+	std::array<uint64_t, static_cast<std::size_t>(eCloseReason::MAX)> closes{};
+	int64_t writeQueueDepth = 0;
+	int64_t writeQueueBytes = 0;
+	uint64_t spinTime = 0;
+	uint64_t workTime = 0;
+	uint64_t blockTime = 0;
+	uint64_t blocks = 0;
+};
+using _throughput_list_t = std::vector<Throughput>;
+
+// 전체 합계와 io 스레드별 통계
+struct MetricsSnapshot
+{
+	Throughput total;
+	_throughput_list_t workers;
+};
+
+// 소켓 옵션을 적용하는 대상
+enum class eSocketTarget
+{
+	LISTEN = 0,
+	ACCEPTED,
+	CONNECTED,
+	MAX,
+};
+
+// 소켓 옵션 적용 결과(대상별로 처음 적용한 결과를 보관한다.)
+struct SocketOptionResult
+{
+	std::string name;
+	int32_t requested = 0;
+	int32_t actual = 0;		// 적용 후 다시 읽은 값(커널이 조정한 값, 예: SO_RCVBUF는 2배)
+	bool applied = false;
+	std::string message;	// 실패 사유
+};
+using _socket_option_report_t = std::vector<SocketOptionResult>;
+
+// 쓰기 버퍼 풀 통계
+// hits : 풀에 보관된 블록을 꺼낸 횟수, misses : 힙에서 새로 할당한 블록 수
+// 스레드 캐시와 공용 목록이 모두 비면 블록을 여러 개 한번에 만들어 두므로, 미리 만든 블록은 misses로 센 뒤 꺼낼 때 hits로도 센다.
+struct BufferPoolStats
+{
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
+// 세션 풀 통계(모든 io 워커의 합)
+// created : 새로 만든 세션 수(미리 만든 수 포함), reused : 보관된 세션을 다시 사용한 횟수, idle : 현재 보관 중인 세션 수
+struct SessionPoolStats
+{
+	uint64_t created = 0;
+	uint64_t reused = 0;
+	uint64_t idle = 0;
+};
+
+// io 스레드의 실제 배치
+// requested : 설정으로 요청한 CPU(비어 있으면 고정하지 않음), cpus : 스레드의 affinity를 다시 읽은 값
+// node : cpus가 모두 속한 NUMA 노드(-1이면 여러 노드에 걸쳐 있거나 알 수 없음), cpu : 마지막으로 확인한 실행 CPU(-1이면 알 수 없음)
+// pinned : 요청한 affinity가 적용되었는지 여부
+struct WorkerPlacement
+{
+	uint32_t index = 0;
+	_cpu_list_t requested;
+	_cpu_list_t cpus;
+	int32_t node = -1;
+	int32_t cpu = -1;
+	bool pinned = false;
+};
+using _placement_list_t = std::vector<WorkerPlacement>;
+
+// 지연 시간 측정 구간(_USE_LATENCY_HISTOGRAM으로 빌드한 경우에만 기록한다.)
+// WRITE_QUEUE : Write/Post 호출 ~ async_write 시작, WRITE_SEND : async_write 시작 ~ 완료
+// WRITE_TOTAL : Write/Post 호출 ~ 전송 완료, READ_DISPATCH : 수신 완료 ~ OnMessage 호출
+enum class eLatencyStage
+{
+	WRITE_QUEUE = 0,
+	WRITE_SEND,
+	WRITE_TOTAL,
+	READ_DISPATCH,
+	MAX,
+};
+
+// 구간별 지연 시간(ns, 모든 io 스레드의 히스토그램을 합친 값)
+struct LatencyReport
+{
+	eLatencyStage stage = eLatencyStage::WRITE_QUEUE;
+	uint64_t count = 0;
+	uint64_t p50 = 0;
+	uint64_t p99 = 0;
+	uint64_t p999 = 0;
+	uint64_t max = 0;
+};
+using _latency_report_t = std::vector<LatencyReport>;
+
+// Write 결과
+enum class eWriteResult
+{
+	SUCCESS = 0,
+	NOT_FOUND,		// 세션이 없거나 종료되었다.
+	WOULD_BLOCK,	// 쓰기 대기 크기가 high watermark 이상이다.(OnWritable 이후 다시 쓴다.)
+};
+
+// 세션별 쓰기 대기 한도(high가 0이면 제한하지 않는다.)
+struct WriteWatermark
+{
+	std::size_t high = 0;
+	std::size_t low = 0;
+	uint32_t timeout = 0;	// high 이상인 상태가 이어지면 연결을 끊을 시간(msec, 0이면 끊지 않음)
+};
+
+// 세션별 연결 확인 시간(msec, 0이면 사용하지 않는다.)
+struct SessionTimeout
+{
+	uint32_t readIdle = 0;
+	uint32_t writeStall = 0;
+	uint32_t heartbeat = 0;
+};
+
+// 세션별 왕복 시간 추정(ns, HeartbeatInterval을 사용할 경우 pong을 받을 때마다 갱신한다.)
+// smoothed/variance는 TCP RTO(RFC 6298)와 같이 1/8, 1/4 가중치로 계산한다.
+struct RttEstimate
+{
+	uint64_t latest = 0;
+	uint64_t smoothed = 0;
+	uint64_t variance = 0;
+	uint64_t min = 0;
+	uint32_t samples = 0;
+};
+
 class IController
 {
 public:
@@ -118,7 +376,45 @@ public:
 
 	virtual bool IsState(const _sid_t& sid, const eState& state) = 0;
 
-	virtual bool Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len) = 0;
-	virtual bool Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer) = 0;
+	// 쓰기 대기 크기가 high watermark 이상이면 큐에 넣지 않고 WOULD_BLOCK을 반환한다.
+	virtual eWriteResult Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len) = 0;
+	virtual eWriteResult Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer) = 0;
+
+	// 하나의 버퍼를 여러 세션에 복사 없이 공유하여 보낸다.(호출 후 버퍼를 수정하면 안된다.)
+	// 세션이 고정된 io 스레드별로 묶어서 전달하며, 보낼 대상으로 찾은 세션 수를 반환한다.(WOULD_BLOCK인 세션은 제외)
+	virtual std::size_t Broadcast(std::span<const _sid_t> sids, std::shared_ptr<IWriteBuffer>& buffer) = 0;
+
+	// 세션의 쓰기 대기 한도를 변경한다.(기본값은 IConfiguration)
+	virtual bool SetWriteWatermark(const _sid_t& sid, const WriteWatermark& watermark) = 0;
+
+	// 세션의 수신을 멈추고 다시 시작한다.(멈춘 동안에는 TCP 수신 윈도우가 차서 상대방의 전송이 늦춰진다.)
+	virtual bool PauseRead(const _sid_t& sid) = 0;
+	virtual bool ResumeRead(const _sid_t& sid) = 0;
+
+	// ReadBudget을 사용할 경우 처리가 끝난 메시지 수를 알린다.(아무 스레드에서나 호출)
+	virtual bool AckMessages(const _sid_t& sid, const uint32_t count) = 0;
+
+	// HeartbeatInterval로 측정한 세션의 왕복 시간(아직 pong을 받지 못했으면 samples가 0이다.)
+	virtual bool GetRtt(const _sid_t& sid, RttEstimate& rtt) = 0;
+
+	virtual void GetThroughput(_throughput_list_t& list) = 0;
+
+	// io 스레드를 멈추지 않고 통계를 모은다.(스레드별 값은 각각 원자적으로 읽으므로 항목 사이에는 약간의 오차가 있을 수 있다.)
+	virtual void Snapshot(MetricsSnapshot& snapshot) = 0;
+
+	// 크기별 풀에서 capacity(길이 헤더 제외) 이상의 쓰기 버퍼를 가져온다.(해제되면 풀로 반납된다.)
+	virtual _write_buffer_ptr_t CreateWriteBuffer(const std::size_t& capacity) = 0;
+	virtual void GetBufferPoolStats(BufferPoolStats& stats) = 0;
+
+	virtual void GetSessionPoolStats(SessionPoolStats& stats) = 0;
+
+	// io 스레드별 CPU/NUMA 배치(스레드가 시작되기 전에는 requested만 채워진다.)
+	virtual void GetPlacement(_placement_list_t& list) = 0;
+
+	// IConfiguration의 소켓 옵션이 실제로 적용되었는지 확인한다.
+	virtual void GetSocketOptionReport(const eSocketTarget& target, _socket_option_report_t& report) = 0;
+
+	// 구간별 지연 시간(_USE_LATENCY_HISTOGRAM 없이 빌드한 경우 비어 있다.)
+	virtual void GetLatencyReport(_latency_report_t& report) = 0;
 };
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <boost/noncopyable.hpp>
 #include <boost/asio.hpp>
 #include "net_interface.h"
+#include "async_logger.h"
+#include "io_worker.h"
+#include "socket_option.h"
 
 #define _USE_UNION
 
@@ -114,16 +117,18 @@ private:
 				return;
 			}
 
-			m_pointer = new uint8_t[m_maxLength * 2];
+			_size_t maxLength = GetGrowLength(n);
+			m_pointer = new uint8_t[maxLength];
 			
 			memcpy(m_pointer, m_buffer.data(), m_offset);
 
 			m_type = eBufferType::DYNAMIC;
-			m_maxLength = m_maxLength * 2;
+			m_maxLength = maxLength;
 			return;
 		}
 
-		uint8_t* pointer = new uint8_t[m_maxLength * 2];
+		_size_t maxLength = GetGrowLength(n);
+		uint8_t* pointer = new uint8_t[maxLength];
 		
 		memcpy(pointer, m_pointer, m_offset);
 		if (nullptr != m_pointer)
@@ -133,7 +138,7 @@ private:
 		}
 
 		m_pointer = pointer;
-		m_maxLength = m_maxLength * 2;
+		m_maxLength = maxLength;
 #else 
 		if (eBufferType::STATIC == m_type)
 		{
@@ -142,17 +147,19 @@ private:
 				return;
 			}
 
-			uint8_t* tmp = new uint8_t[m_maxLength * 2];
+			_size_t maxLength = GetGrowLength(n);
+			uint8_t* tmp = new uint8_t[maxLength];
 
 			memcpy(tmp, m_buffer.arr, m_offset);
 
 			m_type = eBufferType::DYNAMIC;
-			m_maxLength = m_maxLength << 1;
+			m_maxLength = maxLength;
 			m_buffer.pointer = tmp;
 			return;
 		}
 
-		uint8_t* tmp = new uint8_t[m_maxLength * 2];
+		_size_t maxLength = GetGrowLength(n);
+		uint8_t* tmp = new uint8_t[maxLength];
 
 		memcpy(tmp, m_buffer.pointer, m_offset);
 		if (nullptr != m_buffer.pointer)
@@ -162,10 +169,21 @@ private:
 		}
 
 		m_buffer.pointer = tmp;
-		m_maxLength = m_maxLength << 1;
+		m_maxLength = maxLength;
 #endif
 	}
 
+	// 2배씩 늘리되 n을 담을 수 있을 때까지 늘린다.(한번에 큰 데이터를 Put 할 경우)
+	_size_t GetGrowLength(const _size_t& n)
+	{
+		_size_t maxLength = m_maxLength << 1;
+		while (maxLength < (m_offset + n))
+		{
+			maxLength <<= 1;
+		}
+		return maxLength;
+	}
+
 	_size_t m_offset = RESERVED_SPACE_SIZE;
 	eBufferType m_type = eBufferType::STATIC;
 
@@ -186,14 +204,35 @@ private:
 
 class Session;
 class SessionManager;
+class SubmitQueue;
 class NetworkImpl : public IController, private boost::noncopyable
 {
 	using _io_context_t = boost::asio::io_context;
+	using _io_context_ptr_t = std::unique_ptr<_io_context_t>;
+	using _io_context_group_t = std::vector<_io_context_ptr_t>;
+	using _io_worker_group_t = std::vector<_io_worker_ptr_t>;
 	using _acceptor_t = boost::asio::ip::tcp::acceptor;
-	using _acceptor_ptr_t = std::unique_ptr<_acceptor_t>;
+
+	// 리슨 소켓 단위, SO_REUSEPORT를 사용할 경우 워커마다 하나씩 생성하고 accept된 세션은 해당 워커에 고정한다.
+	struct AcceptShard
+	{
+		AcceptShard(_io_context_t& t_ioContext, IoWorker* t_worker)
+			: acceptor(t_ioContext)
+			, worker(t_worker)
+		{
+		}
+
+		_acceptor_t acceptor;
+
+		// nullptr일 경우 세션을 워커에 순서대로 분배한다.
+		IoWorker* worker = nullptr;
+	};
+	using _accept_shard_ptr_t = std::unique_ptr<AcceptShard>;
+	using _accept_shard_group_t = std::vector<_accept_shard_ptr_t>;
 	using _thread_group_t = std::vector<std::thread>;
 	using _signal_set_t = boost::asio::signal_set;
 	using _session_manager_ptr_t = std::unique_ptr<SessionManager>;
+	using _submit_queue_group_t = std::vector<std::unique_ptr<SubmitQueue>>;
 
 public:
 	explicit NetworkImpl(const int32_t numberOfThreads);
@@ -236,28 +275,85 @@ public:
 	virtual _sid_t Connect() override;
 	virtual bool Accept() override;
 
-	virtual bool Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len) override;
-	virtual bool Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer) override;
+	virtual eWriteResult Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len) override;
+	virtual eWriteResult Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer) override;
+	virtual std::size_t Broadcast(std::span<const _sid_t> sids, std::shared_ptr<IWriteBuffer>& buffer) override;
+
+	virtual bool SetWriteWatermark(const _sid_t& sid, const WriteWatermark& watermark) override;
+
+	virtual bool PauseRead(const _sid_t& sid) override;
+	virtual bool ResumeRead(const _sid_t& sid) override;
+	virtual bool AckMessages(const _sid_t& sid, const uint32_t count) override;
+
+	virtual bool GetRtt(const _sid_t& sid, RttEstimate& rtt) override;
+
+	virtual void GetThroughput(_throughput_list_t& list) override;
+	virtual void Snapshot(MetricsSnapshot& snapshot) override;
+
+	virtual _write_buffer_ptr_t CreateWriteBuffer(const std::size_t& capacity) override;
+	virtual void GetBufferPoolStats(BufferPoolStats& stats) override;
+	virtual void GetSessionPoolStats(SessionPoolStats& stats) override;
+
+	virtual void GetPlacement(_placement_list_t& list) override;
+
+	virtual void GetSocketOptionReport(const eSocketTarget& target, _socket_option_report_t& report) override;
+
+	virtual void GetLatencyReport(_latency_report_t& report) override;
 
 private:
+	void CreateWorker();
+	void CreateSocketOptions();
+	void LoadSessionLimits();
+	void CreateSessionPool();
+	void ApplySessionLimits(const boost::shared_ptr<Session>& t_session);
 	void CreateWorkerThread();
 
-	void AcceptInner();
-	void HandleAccept(boost::shared_ptr<Session> session, const boost::system::error_code& t_errorCode);
+	// 설정에 따라 워커 스레드를 고정할 CPU를 정한다.(스레드를 만들기 전에 호출)
+	void AssignCpuSets();
+
+	// 새 세션을 고정할 워커를 순서대로 선택한다.
+	IoWorker& NextWorker();
+
+	// 단독 io_context 워커에 고정된 세션의 쓰기 요청을 제출 큐로 전달한다.
+	void Submit(const boost::shared_ptr<Session>& t_session, std::shared_ptr<const void> t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp);
+
+	void Listen(AcceptShard& t_shard, const boost::asio::ip::tcp::endpoint& t_endpoint, const bool t_reusePort);
+	void AcceptInner(AcceptShard* t_shard);
+	void HandleAccept(AcceptShard* t_shard, boost::shared_ptr<Session> session, const boost::system::error_code& t_errorCode);
 	
 	uint32_t m_numberOfThreads = 0;
 	_io_context_t m_ioContext;
-	_acceptor_ptr_t m_acceptor;
+
+	// PER_THREAD 모델에서 워커 1번부터 사용하는 io_context(워커 0번은 m_ioContext를 사용한다.)
+	_io_context_group_t m_ioContextGroup;
+	_io_worker_group_t m_workerGroup;
+	std::atomic<uint32_t> m_nextWorker{ 0 };
+
+	// PER_THREAD 모델에서 워커별 쓰기 제출 큐(세션을 참조하므로 io_context보다 먼저 해제되어야 한다.)
+	_submit_queue_group_t m_submitQueueGroup;
+
+	_accept_shard_group_t m_acceptShardGroup;
 
 	_signal_set_t m_signalSet;
 
 	_thread_group_t m_threadGroup;
 
 	_session_manager_ptr_t m_sessionManager;
+	bool m_sessionPoolCreated = false;
+
+	// 소켓 옵션 적용(Accept/Connect 시점의 설정으로 생성한다.)
+	_socket_options_ptr_t m_socketOptions;
+
+	// 새 세션에 적용할 쓰기 대기 한도, 수신 한도와 연결 확인 시간(Accept/Connect 시점의 설정)
+	std::optional<WriteWatermark> m_writeWatermark;
+	uint32_t m_readBudget = 0;
+	int32_t m_maxFrameLength = 0;
+	SessionTimeout m_sessionTimeout;
 
 	IConfiguration* m_configuration = nullptr;
 	IListener* m_service = nullptr;
 	ILogging* m_logging = nullptr;
+	Logger m_logger;
 	IMonitor* m_monitor = nullptr;
 };
 }
\ No newline at end of file
@@ -1,235 +1,155 @@
 #pragma once
 
-#include <map>
-#include <shared_mutex>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/aligned_storage.hpp>
+#include "async_logger.h"
 #include "error_code.h"
+#include "handler_memory.h"
 #include "net_interface.h"
+#include "io_worker.h"
+#include "mpsc_queue.h"
+#include "session_table.h"
+#include "socket_option.h"
 #include "stream_buffer.h"
 
-namespace boost
-{
-namespace asio
+namespace net
 {
-class HandlerMemory : private boost::noncopyable
+enum class eWriteState
 {
-public:
-	HandlerMemory()
-		: m_inUse(false)
-	{
-	}
-
-	void* allocate(std::size_t t_size)
-	{
-		if (!m_inUse && t_size < m_storage.size)
-		{
-			m_inUse = true;
-			return m_storage.address();
-		}
-		else
-		{
-			return ::operator new(t_size);
-		}
-	}
-
-	void deallocate(void* t_pointer)
-	{
-		if (t_pointer == m_storage.address())
-		{
-			m_inUse = false;
-		}
-		else
-		{
-			::operator delete(t_pointer);
-		}
-	}
-
-private:
-	// Storage space used for handler-based custom memory allocation.
-	boost::aligned_storage<1024> m_storage;
-
-	// Whether the handler-based custom allocation storage has been used.
-	bool m_inUse;
+	IDEL = 1,
+	WRITING = 2,
 };
 
-// The allocator to be associated with the handler objects. This allocator only
-// needs to satisfy the C++11 minimal allocator requirements, plus rebind when
-// targeting C++03.
-template <typename T>
-class HandlerAllocator
+// async_write 호출 중 재 호출되지 않도록 처리해야함.
+// 만일 async_write가 호출되고 있다면 대기 큐에 메시지를 넣고 async_write가 완료되면 이어서 보내도록 한다.
+// 앱이 만든 버퍼는 복사하지 않고 참조(shared_ptr)만 보관했다가 한번의 async_write(writev)로 모아서 보낸다.
+class WriteQueue : boost::noncopyable
 {
 public:
-	typedef T value_type;
-
-	explicit HandlerAllocator(HandlerMemory& t_mem)
-		: m_memory(t_mem)
-	{
-	}
+	// 한번에 모아서 보내는 최대 버퍼 수(iovec)
+	static constexpr std::size_t MAX_GATHER_BUFFERS = 64;
 
-	template <typename U>
-	HandlerAllocator(const HandlerAllocator<U>& t_other)
-		: m_memory(t_other.m_memory)
-	{
-	}
+	using _holder_t = std::shared_ptr<const void>;
+	using _const_buffer_t = boost::asio::const_buffer;
+	using _gather_buffers_t = std::span<const _const_buffer_t>;
 
-	template <typename U>
-	struct rebind
+	struct Item
 	{
-		typedef HandlerAllocator<U> other;
+		_holder_t holder;
+		_const_buffer_t buffer;
+		[[no_unique_address]] LatencyStamp stamp;	// Write/Post 호출 시각
 	};
+	using _items_t = std::deque<Item, PoolAllocator<Item>>;	// 블록(chunk)을 풀에서 할당한다.
 
-	bool operator==(const HandlerAllocator& t_other) const
-	{
-		return &m_memory == &t_other._memory;
-	}
-
-	bool operator!=(const HandlerAllocator& t_other) const
-	{
-		return &m_memory != &t_other.m_memory;
-	}
-
-	T* allocate(std::size_t t_n) const
-	{
-		return static_cast<T*>(m_memory.allocate(sizeof(T) * t_n));
-	}
+	WriteQueue() = default;
+	~WriteQueue() = default;
 
-	void deallocate(T* t_p, std::size_t /*n*/) const
+	inline bool IsEmpty() const
 	{
-		return m_memory.deallocate(t_p);
+		return m_items.empty();
 	}
 
-	//private:
-		// The underlying memory.
-	HandlerMemory& m_memory;
-};
-
-// Wrapper class template for handler objects to allow handler memory
-// allocation to be customised. The allocator_type typedef and get_allocator()
-// member function are used by the asynchronous operations to obtain the
-// allocator. Calls to operator() are forwarded to the encapsulated handler.
-template <typename Handler>
-class CustomAllocHandler
-{
-public:
-	typedef HandlerAllocator<Handler> allocator_type;
-
-	CustomAllocHandler(HandlerMemory& t_m, Handler t_h)
-		: m_memory(t_m)
-		, m_handler(t_h)
+	// 대기 중인 메시지 수
+	inline std::size_t GetCount() const
 	{
+		return m_items.size();
 	}
 
-	allocator_type get_allocator() const
+	// 대기 중인 크기(byte)
+	inline std::size_t GetLength() const
 	{
-		return allocator_type(m_memory);
+		return m_length;
 	}
 
-	template <typename Arg1>
-	void operator()(Arg1 t_arg1)
+	// 메시지를 대기 큐에 추가한다.(t_holder가 해제되기 전까지 t_data는 유효해야 한다.)
+	void Put(_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_length, const LatencyStamp& t_stamp)
 	{
-		m_handler(t_arg1);
-	}
+		if (0 == t_length)
+		{
+			return;
+		}
 
-	template <typename Arg1, typename Arg2>
-	void operator()(Arg1 t_arg1, Arg2 t_arg2)
-	{
-		m_handler(t_arg1, t_arg2);
+		m_items.push_back({ std::move(t_holder), _const_buffer_t(t_data, t_length), t_stamp });
+		m_length += t_length;
 	}
 
-private:
-	HandlerMemory& m_memory;
-	Handler m_handler;
-};
-
-// Helper function to wrap a handler object to add custom allocation.
-template <typename Handler>
-inline CustomAllocHandler<Handler> make_custom_alloc_handler(HandlerMemory& t_m, Handler t_h)
-{
-	return CustomAllocHandler<Handler>(t_m, t_h);
-}
-} // end namespace asio
-} // end namespace boost
-
-namespace net
-{
-enum class eWriteState
-{
-	IDEL = 1,
-	WRITING = 2,
-};
-
-// async_write 호출 중 재 호출되지 않도록 처리해야함.
-// 만일 async_write가 호출되고 있다면 대기 buffer에 메시지를 넣고 async_write가 완료되면 이어서 보내도록 한다.
-class WriteQueue : boost::noncopyable
-{
-public:
-	using _streambuf_t = boost::asio::streambuf;
-	using _buffers_t = std::array<_streambuf_t, 2>;
-
-	enum class eBufferType
+	// 대기 큐 앞에서부터 최대 MAX_GATHER_BUFFERS 개의 버퍼를 모은다.
+	// 반환된 버퍼는 다음 Gather 호출 전까지 유효하다.
+	_gather_buffers_t Gather()
 	{
-		NONE = 0,
-		CURRENT = 1,
-		WRITING = 2,
-	};
+		std::size_t count = std::min(m_items.size(), MAX_GATHER_BUFFERS);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			m_gatherBuffers[i] = m_items[i].buffer;
+		}
 
-	WriteQueue()
-		: m_currentBuffer(&m_buffers[0])
-		, m_writingBuffer(&m_buffers[1])
-	{
+		return _gather_buffers_t(m_gatherBuffers.data(), count);
 	}
 
-	~WriteQueue() = default;
-
-	inline eBufferType GetTransmissibleBufferType()
+	// 앞에서부터 t_count개의 메시지를 순회한다.(지연 시간 측정용)
+	template <typename Func>
+	void ForEach(const std::size_t t_count, Func&& t_func) const
 	{
-		if (0 < m_writingBuffer->size())
+		std::size_t count = std::min(m_items.size(), t_count);
+		for (std::size_t i = 0; i < count; ++i)
 		{
-			return eBufferType::WRITING;
+			t_func(m_items[i]);
 		}
-		else if (0 < m_currentBuffer->size())
-		{
-			return eBufferType::CURRENT;
-		}
-
-		return eBufferType::NONE;
 	}
 
-	// 데이터가 기록된 버퍼의 const_buffer_type으로 반환한다.
-	const _streambuf_t& GetCurrentBuffer() const
+	// t_length 만큼 보냈을 때 전송이 끝나는 메시지를 순회한다.(Consume 전에 호출)
+	template <typename Func>
+	void ForEachCompleted(std::size_t t_length, Func&& t_func) const
 	{
-		return *m_currentBuffer;
-	}
+		for (const Item& item : m_items)
+		{
+			if (item.buffer.size() > t_length)
+			{
+				break;
+			}
 
-	const _streambuf_t& GetWritingBuffer() const
-	{
-		return *m_writingBuffer;
+			t_length -= item.buffer.size();
+			t_func(item);
+		}
 	}
 
-	// 메시지를 대기 버퍼에 추가한다.
-	void Put(const uint8_t* t_data, const std::size_t& t_length)
+	// 남은 메시지 참조를 모두 해제한다.
+	void Clear()
 	{
-		m_currentBuffer->sputn(reinterpret_cast<const char*>(t_data), t_length);
+		m_items.clear();
+		m_length = 0;
 	}
 
-	// sending buffer 보내진 만큼 삭제
-	void Consume(const std::size_t& t_length)
+	// 보내진 만큼 대기 큐에서 삭제
+	void Consume(std::size_t t_length)
 	{
-		m_writingBuffer->consume(t_length);
-	}
+		m_length -= std::min(t_length, m_length);
 
-	void Switch()
-	{
-		std::swap(m_currentBuffer, m_writingBuffer);
+		while (0 < t_length && false == m_items.empty())
+		{
+			Item& item = m_items.front();
+			if (item.buffer.size() > t_length)
+			{
+				item.buffer += t_length;
+				break;
+			}
+
+			t_length -= item.buffer.size();
+			m_items.pop_front();
+		}
 	}
 
 private:
-	_buffers_t m_buffers;
-	_streambuf_t* m_currentBuffer = nullptr;
-	_streambuf_t* m_writingBuffer = nullptr;
+	_items_t m_items;
+	std::size_t m_length = 0;
+	std::array<_const_buffer_t, MAX_GATHER_BUFFERS> m_gatherBuffers;
 };
 
 class Session : public boost::enable_shared_from_this<Session>, private boost::noncopyable
@@ -237,17 +157,60 @@ class Session : public boost::enable_shared_from_this<Session>, private boost::n
 	using _io_context_t = boost::asio::io_context;
 	using _resolver_t = boost::asio::ip::tcp::resolver;
 	using _resolver_ptr_t = std::unique_ptr<_resolver_t>;
-	using _socket_t = boost::asio::ip::tcp::socket;
-	using _strand_t = boost::asio::strand<_io_context_t::executor_type>;
-	//using _read_buffer_t = boost::asio::streambuf;
-	using _read_buffer_t = std::array<uint8_t, 1024>;
+	using _socket_t = IoWorker::_socket_t;
+	using _strand_t = IoWorker::_strand_t;
+	using _read_buffer_t = StreamBuffer<1024>;
+	using _read_regions_t = std::array<std::pair<uint8_t*, int32_t>, 2>;
 	using _destroy_callback_t = std::function<void(const _sid_t& sid)>;
+	using _control_frame_t = std::array<uint8_t, sizeof(int32_t) + sizeof(uint64_t)>;
+
+	// 휠에서 만료되면 세션의 executor로 HandleTimer를 예약한다.
+	class Timer : public TimerWheel::Node
+	{
+	public:
+		explicit Timer(Session& t_session) : m_session(t_session) {}
+
+		virtual void OnExpire() override { m_session.OnTimerExpire(); }
+
+	private:
+		Session& m_session;
+	};
 
 public:
-	explicit Session(const _sid_t& sid, _io_context_t& t_ioContext, IListener* t_service, ILogging* t_logging, IMonitor* t_monitor, _destroy_callback_t&& t_destroyCallback);
+	// 한번에 수신할 크기(가득 채워 수신하면 2배로 늘리고, 작은 수신이 이어지면 절반으로 줄인다.)
+	static constexpr int32_t MIN_READ_SIZE = 1024;
+	static constexpr int32_t MAX_READ_SIZE = 64 * 1024;
+	static constexpr int32_t SHRINK_READ_COUNT = 8;
+
+	// 프레임 데이터 크기 한도(수신 버퍼가 프레임 하나와 한번의 수신을 담을 수 있는 범위로 제한한다.)
+	static constexpr int32_t DEFAULT_MAX_FRAME_LENGTH = 1024 * 1024;
+	static constexpr int32_t MAX_FRAME_LENGTH = _read_buffer_t::MAX_CAPACITY / 2;
+
+	// 제어 프레임(길이 자리에 음수를 넣고 8byte 값을 붙인다, 서비스에는 전달하지 않는다.)
+	// PING을 받으면 값을 그대로 PONG으로 돌려주고, PONG의 값(보낸 시각)으로 RTT를 계산한다.
+	enum class eControlFrame : int32_t
+	{
+		PING = -1,
+		PONG = -2,
+	};
+
+	explicit Session(const _sid_t& sid, IoWorker& t_worker, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor, _destroy_callback_t&& t_destroyCallback);
+	~Session();
+
+	// 닫힌 세션을 처음 만든 상태로 되돌린다.(참조가 모두 해제된 뒤 SessionPool에서 호출한다.)
+	// 수신 버퍼, strand, 소켓 객체와 핸들러 메모리는 그대로 두고 다음 연결에 사용한다.
+	void Reset();
+
+	// 풀에서 꺼낸 세션에 새 연결의 sid와 서비스를 지정한다.
+	void Reuse(const _sid_t& t_sid, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor);
 
 	inline _socket_t& getSocket() { return m_socket; }
 
+	inline IoWorker& GetWorker() { return m_worker; }
+
+	// async_accept 핸들러 메모리(핸들러가 세션을 참조하므로 완료될 때까지 유지된다.)
+	inline boost::asio::HandlerMemory& GetAcceptMemory() { return m_connectMemory; }
+
 	inline const _sid_t GetSID() { return m_sid; }
 
 	inline bool IsState(const eState t_state)
@@ -255,15 +218,45 @@ public:
 		return (m_state == t_state);
 	}
 
+	// 연결이 완료되면 적용할 소켓 옵션(connect 하는 세션만 사용)
+	inline void AttachSocketOptions(SocketOptions* t_socketOptions) { m_socketOptions = t_socketOptions; }
+
 	void Resolve(const std::string& t_address, const std::string& t_port);
 
 	void Start();
 
 	void PostClose(boost::system::error_code t_errorCode);
 
+	// Reserve 이후 호출한다.
 	void Post(std::shared_ptr<uint8_t> t_data, const std::size_t& t_len);
 	void Post(std::shared_ptr<IWriteBuffer>& t_buffer);
 
+	// 쓰기 요청 전에 다른 스레드에서 호출한다.
+	// 쓰기 대기 크기가 high watermark 이상이면 false를 반환하고, low watermark 이하로 줄면 OnWritable을 호출한다.
+	bool Reserve(const std::size_t& t_len);
+
+	void SetWriteWatermark(const WriteWatermark& t_watermark);
+
+	// 연결 확인 시간(Start 이전에 호출한다.)
+	void SetTimeout(const SessionTimeout& t_timeout);
+
+	// 다른 스레드에서 호출할 수 있다.
+	void GetRtt(RttEstimate& t_rtt) const;
+
+	// 다른 스레드에서 호출한다.(세션의 executor에서 처리)
+	void PauseRead();
+	void ResumeRead();
+
+	// OnMessage로 전달한 뒤 처리가 끝나지 않은 메시지 수가 t_budget에 도달하면 AckMessages까지 수신을 멈춘다.(0이면 사용하지 않음)
+	inline void SetReadBudget(const uint32_t t_budget) { m_readBudget.store(t_budget, std::memory_order_relaxed); }
+
+	// 길이가 t_length보다 큰 프레임을 받으면 연결을 끊는다.(Start 이전에 호출한다.)
+	inline void SetMaxFrameLength(const int32_t t_length) { m_maxFrameLength = std::clamp(t_length, 1, MAX_FRAME_LENGTH); }
+	void AckMessages(const uint32_t& t_count);
+
+	// 세션의 executor에서 바로 쓰기를 처리한다.(단독 io_context 워커의 스레드에서만 호출)
+	void Deliver(WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp);
+
 private:
 	inline void SetState(const eState t_state)
 	{
@@ -271,9 +264,54 @@ private:
 	}
 
 	void Read();
-	void Write(const uint8_t* t_data, const std::size_t& t_len);
+	void AdjustReadSize(const std::size_t& t_bytesTransferred);
+
+	// 수신 버퍼의 완성된 프레임을 전달한다.(세션이 종료되었으면 false)
+	bool Dispatch(const LatencyStamp& t_readStamp);
+
+	// 멈췄던 수신을 남은 프레임부터 다시 시작한다.
+	void ContinueRead();
+
+	inline bool CanRead() const
+	{
+		if (true == m_readPaused)
+		{
+			return false;
+		}
+
+		uint32_t budget = m_readBudget.load(std::memory_order_relaxed);
+		return (0 == budget || budget > m_unprocessed.load(std::memory_order_acquire));
+	}
+	void Write(WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp);
+	void Send();
 	void Close(boost::system::error_code t_errorCode);
 
+	// 보냈거나 버려진 크기를 쓰기 대기 크기에서 뺀다.
+	inline void Release(const std::size_t& t_len)
+	{
+		m_pendingBytes.fetch_sub(t_len, std::memory_order_acq_rel);
+	}
+
+	// 막힌 상태에서 low watermark 이하로 줄었으면 OnWritable을 호출한다.
+	void CheckWritable();
+
+	// 쓰기 대기 크기가 high watermark 이상인 상태가 이어지면 연결을 끊는다.(HandleTimer에서 확인)
+	void StartBlockTimer();
+	void StopBlockTimer();
+
+	// 타이머(읽기 유휴, 쓰기 정체, 쓰기 막힘, heartbeat)
+	// 수신/송신마다 마지막 tick만 기록하고, 만료되면 남은 시간을 확인하여 다시 건다.
+	inline uint64_t GetTick() const { return m_worker.GetTimerWheel().GetTick(); }
+	void OnTimerExpire();
+	void HandleTimer();
+	void ScheduleTimer();
+	void ArmTimer(const uint64_t t_expire);
+
+	// 제어 프레임
+	void SendControl(const eControlFrame t_type, const uint64_t t_value);
+	void HandleControl(const eControlFrame t_type, const uint64_t t_value);
+	void UpdateRtt(const uint64_t t_rtt);
+
 	template <typename Callback>
 	bool Post(Callback t_callback)
 	{
@@ -282,11 +320,45 @@ private:
 			OnError(boost::system::make_error_code(net::eErrorCode::NOT_CONNECTED));
 			return false;
 		}
-		m_strand.post(t_callback, std::allocator<char>());
+		PostHandler(std::move(t_callback));
 	
 		return true;
 	}
 
+	// 공유 io_context에서 세션의 strand를 실행 중인 스레드인지 여부
+	inline bool IsInStrand() const
+	{
+		return (true == m_strand.has_value() && true == m_strand->running_in_this_thread());
+	}
+
+	// 세션의 executor로 예약한다.(공유 io_context일 경우 strand로 직렬화한다.)
+	template <typename Handler>
+	inline void PostHandler(Handler t_handler)
+	{
+		if (true == m_strand.has_value())
+		{
+			boost::asio::post(*m_strand, boost::asio::make_pool_alloc_handler(std::move(t_handler)));
+		}
+		else
+		{
+			boost::asio::post(m_socket.get_executor(), boost::asio::make_pool_alloc_handler(std::move(t_handler)));
+		}
+	}
+
+	// 완료 핸들러를 세션의 executor에 묶어 t_initiate로 비동기 작업을 시작한다.
+	template <typename Initiate, typename Handler>
+	inline void StartOperation(Initiate&& t_initiate, Handler t_handler)
+	{
+		if (true == m_strand.has_value())
+		{
+			t_initiate(boost::asio::bind_executor(*m_strand, std::move(t_handler)));
+		}
+		else
+		{
+			t_initiate(std::move(t_handler));
+		}
+	}
+
 	void HandleRead(const boost::system::error_code& t_errorCode, std::size_t t_bytesTransferred);
 	void HandleWrite(const boost::system::error_code& t_errorCode, std::size_t t_bytesTransferred);
 	void HandleResolve(const boost::system::error_code& t_errorCode, const boost::asio::ip::tcp::resolver::results_type& t_endpoints);
@@ -311,49 +383,194 @@ private:
 	void OnClose(const boost::system::error_code& t_errorCode);
 	void OnMessage(const uint8_t* t_data, const std::size_t& t_len);
 	void OnError(const boost::system::error_code& t_errorCode);
+	void OnWritable();
+
+	template <eLogLevel Level>
+	inline void Log(const char* function, const int32_t line, const boost::system::error_code& t_errorCode)
+	{
+		m_logger.Write<Level>(function, line, t_errorCode);
+	}
 
-	void Log(const eLogLevel& t_level, const char* function, const int32_t line, const boost::system::error_code& t_errorCode);
-	void Log(const eLogLevel& t_level, const char* function, const int32_t line, const std::string_view t_message);
+	template <eLogLevel Level>
+	inline void Log(const char* function, const int32_t line, const std::string_view t_message)
+	{
+		m_logger.Write<Level>(function, line, t_message);
+	}
 
 	eState m_state = eState::NONE;
 
 	_sid_t m_sid = 0;
 	
 	_resolver_ptr_t m_resolver;
+	SocketOptions* m_socketOptions = nullptr;
 
-	_io_context_t& m_ioContext;
-	_strand_t m_strand;
+	// 세션이 고정된 워커, 단독 io_context일 경우 strand 없이 워커의 executor를 사용한다.
+	IoWorker& m_worker;
+	std::optional<_strand_t> m_strand;
 	_socket_t m_socket;
 
-	// 리드 버퍼
-	_read_buffer_t m_readBuffer;
-	StreamBuffer<1024> m_messageBuffer;
+	// 리드 버퍼(빈 공간에 직접 수신한다.)
+	_read_buffer_t m_messageBuffer;
+	int32_t m_readSize = MIN_READ_SIZE;
+	int32_t m_smallReadCount = 0;
+	int32_t m_maxFrameLength = DEFAULT_MAX_FRAME_LENGTH;
 
-	// 쓰기 버퍼, 이중으로 되어 있음.
+	// 수신 버퍼 끝에서 나뉜 프레임을 이어 붙이는 용도(재사용)
+	std::vector<uint8_t> m_frameBuffer;
+
+	// 수신 흐름 제어(m_reading, m_readPaused는 세션의 executor에서만 변경한다.)
+	bool m_reading = false;
+	bool m_readPaused = false;
+	std::atomic<uint32_t> m_readBudget{ 0 };
+	std::atomic<uint32_t> m_unprocessed{ 0 };
+
+	// 쓰기 대기 큐
 	eWriteState m_writeState{ eWriteState::IDEL };
 	WriteQueue m_writeQueue;
+	[[no_unique_address]] LatencyStamp m_sendStamp;	// async_write 시작 시각
+
+	// 쓰기 대기 한도(다른 스레드에서 요청한 크기까지 포함하여 집계한다.)
+	std::atomic<std::size_t> m_pendingBytes{ 0 };
+	std::atomic<std::size_t> m_highWatermark{ 0 };
+	std::atomic<std::size_t> m_lowWatermark{ 0 };
+	std::atomic<uint32_t> m_blockTimeout{ 0 };
+	std::atomic<bool> m_writeBlocked{ false };
+	bool m_blockTimerActive = false;
+	uint64_t m_blockSince = 0;	// high 이상이 된 tick
+
+	// 연결 확인(tick, 아래는 세션의 executor에서만 사용한다.)
+	Timer m_timer{ *this };
+	uint64_t m_timerExpire = 0;	// 휠에 걸어둔 만료 tick(0이면 걸려 있지 않다.)
+	uint64_t m_readIdleTicks = 0;
+	uint64_t m_writeStallTicks = 0;
+	uint64_t m_heartbeatTicks = 0;
+	uint64_t m_lastRead = 0;
+	uint64_t m_lastWrite = 0;	// async_write 시작, 완료
+	uint64_t m_lastPing = 0;
+
+	// 왕복 시간(ns)
+	std::atomic<uint64_t> m_rttLatest{ 0 };
+	std::atomic<uint64_t> m_rttSmoothed{ 0 };
+	std::atomic<uint64_t> m_rttVariance{ 0 };
+	std::atomic<uint64_t> m_rttMin{ 0 };
+	std::atomic<uint32_t> m_rttSamples{ 0 };
 
 	// 서비스
 	//_listener_ptr_t m_service;
 	IListener* m_service;
-	ILogging* m_logging;
+	Logger m_logger;
 	IMonitor* m_monitor;
 
-	// asio 핸들러 커스텀 메모리 할당자
-	boost::asio::HandlerMemory m_handlerMemory;
+	// asio 핸들러 커스텀 메모리 할당자(작업 종류별 슬롯, 같은 종류의 작업은 동시에 하나만 진행된다.)
+	// PostHandler로 예약하는 핸들러와 strand의 작업은 BufferPool에서 할당한다.(IoWorker::GetExecutor)
+	boost::asio::HandlerSlot<256> m_readMemory;
+	boost::asio::HandlerSlot<512> m_writeMemory;
+	boost::asio::HandlerSlot<320> m_connectMemory;	// accept, resolve, connect(연결 전에 순서대로 하나씩)
 
 	// 연결 종료 시 정리
 	_destroy_callback_t m_destroyCallback;
 };
 using _session_ptr_t = boost::shared_ptr<Session>;
 
+// 다른 스레드에서 요청한 쓰기를 io 스레드(단독 io_context 워커)로 전달하는 제출 큐
+// 요청마다 post 하지 않고 큐에 쌓은 뒤, 비어 있던 큐에 처음 넣은 스레드만 io 스레드를 한번 깨운다.
+// io 스레드는 깨어날 때마다 쌓인 요청을 묶어서 처리한다.
+class SubmitQueue : boost::noncopyable
+{
+public:
+	// 한번 깨어났을 때 처리하는 최대 요청 수(나머지는 다시 post 하여 다른 핸들러가 굶지 않도록 한다.)
+	static constexpr std::size_t MAX_BATCH = 1024;
+
+	struct Submission
+	{
+		_session_ptr_t session;
+		WriteQueue::_holder_t holder;
+		const uint8_t* data = nullptr;
+		std::size_t length = 0;
+		[[no_unique_address]] LatencyStamp stamp;
+	};
+
+	explicit SubmitQueue(IoWorker& t_worker);
+
+	void Submit(const _session_ptr_t& t_session, WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp);
+
+private:
+	void Schedule();
+	void Drain();
+
+	IoWorker& m_worker;
+	MpscQueue<Submission> m_queue;
+
+	// Drain이 예약되어 있는지 여부
+	alignas(64) std::atomic<bool> m_scheduled{ false };
+};
+using _submit_queue_ptr_t = std::unique_ptr<SubmitQueue>;
+
+// 워커별 세션 풀
+// 마지막 참조가 해제된 세션을 Reset하여 보관했다가 같은 워커의 새 연결에 다시 사용한다.
+// 참조 카운트 블록은 BufferPool에서 할당하므로 보관된 세션이 있으면 연결마다 힙 할당이 없다.
+// 세션이 풀의 소유자보다 늦게 해제될 수 있으므로 반환 함수(Deleter)가 풀을 참조하고, 닫힌 풀로 반환된 세션은 해제한다.
+class SessionPool : public std::enable_shared_from_this<SessionPool>, private boost::noncopyable
+{
+public:
+	using _destroy_callback_t = std::function<void(const _sid_t& sid)>;
+
+	SessionPool(IoWorker& t_worker, const std::size_t t_capacity, _destroy_callback_t&& t_destroyCallback);
+	~SessionPool();
+
+	// 보관 수가 t_count가 될 때까지 세션을 미리 만든다.
+	void Warmup(const std::size_t t_count);
+
+	// 보관된 세션이 없으면 새로 만든다.
+	_session_ptr_t Acquire(const _sid_t& t_sid, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor);
+
+	// 보관 중인 세션을 해제하고, 이후 반환되는 세션은 보관하지 않는다.
+	void Close();
+
+	void GetStats(SessionPoolStats& t_stats);
+
+private:
+	struct Deleter
+	{
+		std::shared_ptr<SessionPool> pool;
+
+		void operator()(Session* t_session) const
+		{
+			pool->Release(t_session);
+		}
+	};
+
+	Session* Create();
+	void Release(Session* t_session);
+
+	IoWorker& m_worker;
+	std::size_t m_capacity = 0;
+	_destroy_callback_t m_destroyCallback;
+
+	std::mutex m_mutex;
+	std::vector<Session*> m_idle;
+	bool m_closed = false;
+
+	std::atomic<uint64_t> m_created{ 0 };
+	std::atomic<uint64_t> m_reused{ 0 };
+};
+using _session_pool_ptr_t = std::shared_ptr<SessionPool>;
+
 class SessionManager : boost::noncopyable
 {
 public:
-	using _io_context_t = boost::asio::io_context;
-	using _session_map_t = std::map<_sid_t, _session_ptr_t>;
+	using _session_table_t = SessionTable<_session_ptr_t>;
+
+	explicit SessionManager(const uint32_t t_numberOfShards);
+	~SessionManager();
 	
-	bool Create(_io_context_t& t_ioContext, IListener* t_service, ILogging* t_logging, IMonitor* t_monitor, _session_ptr_t& session);
+	bool Create(IoWorker& t_worker, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor, _session_ptr_t& session);
+
+	// t_worker의 세션 풀을 만들고 t_warmup개의 세션을 미리 만든다.(io 스레드를 시작하기 전에 호출한다.)
+	// 세션 메모리가 워커 스레드의 NUMA 노드에 놓이도록 미리 만드는 작업은 워커 스레드에서 실행한다.
+	void CreatePool(IoWorker& t_worker, const std::size_t t_capacity, const std::size_t t_warmup);
+
+	void GetPoolStats(SessionPoolStats& t_stats);
 
 	bool Lookup(const _sid_t& t_sid, _session_ptr_t& t_session);
 
@@ -361,17 +578,24 @@ public:
 
 	void Remove(const _sid_t& t_sid);
 
-private:
-	inline _sid_t GeneratedSID()
+	// sid에 기록된 소유 워커 인덱스
+	static inline uint32_t GetWorkerIndex(const _sid_t& t_sid)
 	{
-		return ++m_currentSID;
+		return _session_table_t::GetShard(t_sid);
 	}
 
-	mutable std::shared_mutex m_rwMutex;
+private:
+	// 워커별 샤드에 슬롯을 예약하여 sid를 발급한다.
+	inline _sid_t GeneratedSID(const IoWorker& t_worker)
+	{
+		return m_sessionTable.Reserve(t_worker.GetIndex());
+	}
 
-	std::atomic<_sid_t> m_currentSID{ 0 };
+	// 조회는 lock 없이 처리하고 추가/삭제만 샤드 단위로 직렬화한다.
+	_session_table_t m_sessionTable;
 
-	_session_map_t m_sessionMap;
+	// 워커 인덱스별 세션 풀(nullptr일 경우 연결마다 새로 만든다.)
+	std::vector<_session_pool_ptr_t> m_pools;
 };
 
 using _session_manager_ptr_t = std::unique_ptr<SessionManager>;
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "net_define.h"
+#include "epoch.h"
+
+namespace net
+{
+// 세대(generation) 기반 슬롯맵 세션 테이블
+// - sid = [샤드 8bit][세대 24bit][슬롯 인덱스 32bit], 샤드는 세션이 고정된 워커 인덱스를 사용한다.
+// - 조회는 인덱스로 슬롯을 바로 찾고 세대를 비교하기만 하므로 O(1)이며 lock을 잡지 않는다.
+// - 세션이 제거되면 슬롯의 세대를 올려 재사용하므로, 종료된 세션의 sid는 세대가 달라 거부된다.
+// - 추가/삭제는 샤드 단위 mutex로 직렬화하고, 제거된 항목은 EpochDomain으로 지연 해제한다.
+template <typename Value>
+class SessionTable : private boost::noncopyable
+{
+public:
+	static constexpr uint32_t MAX_SHARDS = 1u << 8;
+	static constexpr uint32_t GENERATION_BITS = 24;
+	static constexpr uint32_t INDEX_BITS = 32;
+
+	static constexpr uint32_t CHUNK_BITS = 12;
+	static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+	static constexpr uint32_t MAX_CHUNKS = 1024;	// 샤드당 최대 4M 세션
+
+	static inline uint32_t GetShard(const _sid_t& t_sid)
+	{
+		return static_cast<uint32_t>(t_sid >> (GENERATION_BITS + INDEX_BITS));
+	}
+
+	static inline uint32_t GetGeneration(const _sid_t& t_sid)
+	{
+		return static_cast<uint32_t>(t_sid >> INDEX_BITS) & ((1u << GENERATION_BITS) - 1);
+	}
+
+	static inline uint32_t GetIndex(const _sid_t& t_sid)
+	{
+		return static_cast<uint32_t>(t_sid);
+	}
+
+	static inline _sid_t MakeSID(const uint32_t t_shard, const uint32_t t_generation, const uint32_t t_index)
+	{
+		return (static_cast<_sid_t>(t_shard) << (GENERATION_BITS + INDEX_BITS))
+			| (static_cast<_sid_t>(t_generation) << INDEX_BITS)
+			| static_cast<_sid_t>(t_index);
+	}
+
+private:
+	struct Entry
+	{
+		Entry(const _sid_t& t_sid, const Value& t_value)
+			: sid(t_sid)
+			, value(t_value)
+		{
+		}
+
+		// 해제된 항목은 샤드에 보관했다가 재사용한다.(읽기 스레드가 모두 지나간 뒤에만 변경한다.)
+		_sid_t sid;
+		Value value;
+	};
+
+	// sid가 0이면 비어 있는 슬롯, sid가 있고 entry가 nullptr이면 예약만 된 슬롯이다.
+	struct Slot
+	{
+		std::atomic<_sid_t> sid{ 0 };
+		std::atomic<Entry*> entry{ nullptr };
+		uint32_t generation = 1;	// 다음에 발급할 세대(쓰기 쪽만 접근)
+	};
+
+	struct Chunk
+	{
+		std::array<Slot, CHUNK_SIZE> slots;
+	};
+
+	struct alignas(64) Shard
+	{
+		std::array<std::atomic<Chunk*>, MAX_CHUNKS> chunks{};
+
+		std::mutex mutex;
+		uint32_t capacity = 0;
+		uint32_t live = 0;
+		std::vector<uint32_t> freeIndexes;
+
+		std::vector<std::pair<uint64_t, Entry*>> retiredEntries;
+		std::vector<Entry*> freeEntries;
+	};
+	using _shard_ptr_t = std::unique_ptr<Shard>;
+
+public:
+	explicit SessionTable(const uint32_t t_numberOfShards, EpochDomain& t_domain = EpochDomain::Instance())
+		: m_domain(t_domain)
+	{
+		uint32_t numberOfShards = std::min(std::max<uint32_t>(t_numberOfShards, 1), MAX_SHARDS);
+		for (uint32_t i = 0; i < numberOfShards; ++i)
+		{
+			m_shards.emplace_back(new Shard);
+		}
+	}
+
+	~SessionTable()
+	{
+		for (auto& shard : m_shards)
+		{
+			for (auto& chunk : shard->chunks)
+			{
+				Chunk* pointer = chunk.load(std::memory_order_relaxed);
+				if (nullptr == pointer)
+				{
+					break;
+				}
+
+				for (auto& slot : pointer->slots)
+				{
+					delete slot.entry.load(std::memory_order_relaxed);
+				}
+				delete pointer;
+			}
+
+			for (auto& retired : shard->retiredEntries)
+			{
+				delete retired.second;
+			}
+
+			for (auto entry : shard->freeEntries)
+			{
+				delete entry;
+			}
+		}
+	}
+
+	inline uint32_t GetNumberOfShards() const
+	{
+		return static_cast<uint32_t>(m_shards.size());
+	}
+
+	bool Lookup(const _sid_t& t_sid, Value& t_value)
+	{
+		const uint32_t shardIndex = GetShard(t_sid);
+		if (m_shards.size() <= shardIndex)
+		{
+			return false;
+		}
+
+		const uint32_t index = GetIndex(t_sid);
+		if ((MAX_CHUNKS << CHUNK_BITS) <= index)
+		{
+			return false;
+		}
+
+		Shard& shard = *m_shards[shardIndex];
+
+		EpochDomain::Guard guard(m_domain);
+
+		const Chunk* chunk = shard.chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+		if (nullptr == chunk)
+		{
+			return false;
+		}
+
+		const Slot& slot = chunk->slots[index & (CHUNK_SIZE - 1)];
+		if (t_sid != slot.sid.load(std::memory_order_acquire))
+		{
+			// 세대가 다르면 이미 종료된 세션의 sid이다.
+			return false;
+		}
+
+		const Entry* entry = slot.entry.load(std::memory_order_acquire);
+		if (nullptr == entry || t_sid != entry->sid)
+		{
+			return false;
+		}
+
+		t_value = entry->value;
+		return true;
+	}
+
+	// 샤드에서 빈 슬롯을 예약하고 sid를 발급한다.(실패 시 0)
+	_sid_t Reserve(const uint32_t t_shard)
+	{
+		const uint32_t shardIndex = t_shard % static_cast<uint32_t>(m_shards.size());
+		Shard& shard = *m_shards[shardIndex];
+
+		std::lock_guard lock(shard.mutex);
+
+		Reclaim(shard);
+
+		uint32_t index = 0;
+		if (false == shard.freeIndexes.empty())
+		{
+			index = shard.freeIndexes.back();
+			shard.freeIndexes.pop_back();
+		}
+		else
+		{
+			if ((MAX_CHUNKS << CHUNK_BITS) <= shard.capacity)
+			{
+				return 0;
+			}
+
+			index = shard.capacity++;
+			if (0 == (index & (CHUNK_SIZE - 1)))
+			{
+				shard.chunks[index >> CHUNK_BITS].store(new Chunk, std::memory_order_release);
+			}
+		}
+
+		Slot& slot = GetSlot(shard, index);
+		_sid_t sid = MakeSID(shardIndex, slot.generation, index);
+		slot.sid.store(sid, std::memory_order_release);
+
+		return sid;
+	}
+
+	// 예약된 sid에 값을 게시한다.
+	bool Add(const _sid_t& t_sid, const Value& t_value)
+	{
+		Slot* slot = nullptr;
+		Shard* shard = nullptr;
+		if (false == Find(t_sid, shard, slot))
+		{
+			return false;
+		}
+
+		std::lock_guard lock(shard->mutex);
+
+		if (t_sid != slot->sid.load(std::memory_order_relaxed) || nullptr != slot->entry.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		Reclaim(*shard);
+
+		Entry* entry = nullptr;
+		if (false == shard->freeEntries.empty())
+		{
+			entry = shard->freeEntries.back();
+			shard->freeEntries.pop_back();
+
+			entry->sid = t_sid;
+			entry->value = t_value;
+		}
+		else
+		{
+			entry = new Entry(t_sid, t_value);
+		}
+
+		slot->entry.store(entry, std::memory_order_release);
+		++shard->live;
+
+		return true;
+	}
+
+	// 값을 제거하고 슬롯의 세대를 올려 반납한다.(예약만 된 sid도 반납된다.)
+	void Remove(const _sid_t& t_sid)
+	{
+		Slot* slot = nullptr;
+		Shard* shard = nullptr;
+		if (false == Find(t_sid, shard, slot))
+		{
+			return;
+		}
+
+		std::lock_guard lock(shard->mutex);
+
+		if (t_sid != slot->sid.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		slot->sid.store(0, std::memory_order_release);
+
+		Entry* entry = slot->entry.exchange(nullptr, std::memory_order_acq_rel);
+		if (nullptr != entry)
+		{
+			--shard->live;
+			shard->retiredEntries.emplace_back(m_domain.Advance(), entry);
+		}
+
+		// 세대는 0을 건너뛰고 순환한다.
+		slot->generation = (slot->generation + 1) & ((1u << GENERATION_BITS) - 1);
+		if (0 == slot->generation)
+		{
+			slot->generation = 1;
+		}
+
+		shard->freeIndexes.push_back(GetIndex(t_sid));
+
+		Reclaim(*shard);
+	}
+
+	std::size_t Size()
+	{
+		std::size_t size = 0;
+		for (auto& shard : m_shards)
+		{
+			std::lock_guard lock(shard->mutex);
+			size += shard->live;
+		}
+		return size;
+	}
+
+private:
+	static inline Slot& GetSlot(Shard& t_shard, const uint32_t t_index)
+	{
+		return t_shard.chunks[t_index >> CHUNK_BITS].load(std::memory_order_relaxed)->slots[t_index & (CHUNK_SIZE - 1)];
+	}
+
+	bool Find(const _sid_t& t_sid, Shard*& t_shard, Slot*& t_slot)
+	{
+		const uint32_t shardIndex = GetShard(t_sid);
+		const uint32_t index = GetIndex(t_sid);
+		if (m_shards.size() <= shardIndex || (MAX_CHUNKS << CHUNK_BITS) <= index)
+		{
+			return false;
+		}
+
+		t_shard = m_shards[shardIndex].get();
+
+		Chunk* chunk = t_shard->chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+		if (nullptr == chunk)
+		{
+			return false;
+		}
+
+		t_slot = &chunk->slots[index & (CHUNK_SIZE - 1)];
+		return true;
+	}
+
+	// 샤드 mutex를 잡은 상태에서 호출한다.(Reserve/Add/Remove마다 호출해 세션 참조를 바로 놓는다.)
+	void Reclaim(Shard& t_shard)
+	{
+		if (true == t_shard.retiredEntries.empty())
+		{
+			return;
+		}
+
+		const uint64_t safeEpoch = m_domain.GetSafeEpoch();
+
+		// Retire 목록은 epoch 오름차순이다.
+		auto itr = t_shard.retiredEntries.begin();
+		for (; itr != t_shard.retiredEntries.end() && itr->first < safeEpoch; ++itr)
+		{
+			// 값(세션 참조)만 해제하고 항목은 다음 Add에서 재사용한다.
+			itr->second->value = Value();
+			t_shard.freeEntries.push_back(itr->second);
+		}
+		t_shard.retiredEntries.erase(t_shard.retiredEntries.begin(), itr);
+	}
+
+	EpochDomain& m_domain;
+	std::vector<_shard_ptr_t> m_shards;
+};
+}
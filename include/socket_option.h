@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+#include "async_logger.h"
+#include "io_worker.h"
+#include "net_interface.h"
+
+namespace net
+{
+// IConfiguration의 소켓 옵션을 리슨/accept/connect 소켓에 적용한다.
+// - 옵션마다 설정 후 다시 읽어서 실제로 적용된 값을 기록하고, 대상별로 처음 적용한 결과를 로그로 남긴다.
+// - 리슨 소켓에는 accept된 소켓이 물려받는 옵션(SO_REUSEADDR, SO_RCVBUF/SO_SNDBUF, TCP_MAXSEG)과 대기열 크기를 적용한다.
+// - MMS는 TCP 최대 세그먼트 크기(TCP_MAXSEG)로 적용하며, 연결 이후에는 의미가 없으므로 리슨 소켓에만 적용한다.
+class SocketOptions : private boost::noncopyable
+{
+public:
+	using _acceptor_t = boost::asio::ip::tcp::acceptor;
+	using _socket_t = IoWorker::_socket_t;
+
+	SocketOptions(IConfiguration* t_configuration, const Logger& t_logger);
+
+	// open 후 bind 전에 호출한다.(결과는 Listen에서 기록)
+	void Apply(_acceptor_t& t_acceptor, const bool t_reusePort, _socket_option_report_t& t_report);
+
+	// bind 후 대기열 크기를 적용하여 listen 한다.
+	void Listen(_acceptor_t& t_acceptor, _socket_option_report_t&& t_report);
+
+	// accept/connect 완료 후 호출한다.
+	void Apply(_socket_t& t_socket, const eSocketTarget& t_target);
+
+	void GetReport(const eSocketTarget& t_target, _socket_option_report_t& t_report);
+
+private:
+	template <typename Socket>
+	void ApplyBufferSize(Socket& t_socket, _socket_option_report_t& t_report);
+
+	template <typename Socket>
+	void ApplySegmentSize(Socket& t_socket, _socket_option_report_t& t_report);
+
+	void Report(const eSocketTarget& t_target, _socket_option_report_t&& t_report);
+
+	IConfiguration* m_configuration = nullptr;
+	Logger m_logger;
+
+	std::mutex m_mutex;
+	std::array<std::atomic<bool>, static_cast<std::size_t>(eSocketTarget::MAX)> m_reported{};
+	std::array<_socket_option_report_t, static_cast<std::size_t>(eSocketTarget::MAX)> m_reports;
+};
+using _socket_options_ptr_t = std::unique_ptr<SocketOptions>;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
 #include <array>
+#include <stdexcept>
 
 template <int32_t DefaultCapacity = 1024>
 class StreamBuffer 
@@ -9,6 +11,9 @@ class StreamBuffer
     static constexpr int32_t INITIAL_VALUE = -1;
     
 public:
+    // 늘릴 수 있는 최대 용량(int32_t 위치 계산이 넘치지 않도록 한다.)
+    static constexpr int32_t MAX_CAPACITY = 1 << 30;
+
     StreamBuffer()
         : m_capacity(DefaultCapacity)
         , m_front(-1)
@@ -42,35 +47,110 @@ public:
     }
 
     // Check if the queue is full
+    // t_length 만큼 기록할 공간이 없으면 true
     bool IsFull(int32_t t_length) 
     {
-        if (m_front == 0 && m_rear == m_capacity - 1) 
+        return ((m_capacity - GetLength()) < t_length);
+    }
+
+    // t_length 만큼의 데이터가 연속된 메모리에 있으면 시작 위치를 반환한다.(복사 없이 접근, 끝에서 나뉘었으면 nullptr)
+    // 반환된 포인터는 다음 Write/Consume 전까지만 유효하다.
+    const uint8_t* Peek(const int32_t t_length)
+    {
+        if (GetLength() < t_length)
         {
-            return true;
+            return nullptr;
         }
 
-        if (m_front == m_rear + 1) 
+        if (m_capacity < m_front + t_length)
         {
-            return true;
+            return nullptr;
         }
 
-        // 한바퀴 돌지 않았을 경우
-        int32_t availableSpace = 0;
+        return m_pointer + m_front;
+    }
+
+    // 빈 공간에 직접 수신하기 위해 t_length 만큼의 공간을 확보하고, 빈 공간을 최대 두 구간으로 반환한다.(끝에서 나뉘는 경우)
+    // 반환된 구간은 Commit 전까지만 유효하며, 반환된 전체 크기는 t_length 이하이다.
+    int32_t Prepare(const int32_t t_length, std::array<std::pair<uint8_t*, int32_t>, 2>& t_regions)
+    {
+        while (IsFull(t_length))
+        {
+            Grow();
+        }
+
+        t_regions[0] = { nullptr, 0 };
+        t_regions[1] = { nullptr, 0 };
+
+        if (IsEmpty())
+        {
+            t_regions[0] = { m_pointer, t_length };
+            return t_length;
+        }
+
+        std::array<int, 2> split;
         if (m_front < m_rear)
         {
-            availableSpace = m_capacity - (m_rear - m_front);
+            split[0] = m_capacity - m_rear;
+            split[1] = m_front;
         }
         else
         {
-            availableSpace = m_capacity - m_front + m_rear;
+            split[0] = m_front - m_rear;
+            split[1] = 0;
         }
 
-        if (t_length > availableSpace)
+        split[0] = std::min(split[0], t_length);
+        split[1] = std::min(split[1], t_length - split[0]);
+
+        t_regions[0] = { m_pointer + m_rear, split[0] };
+        t_regions[1] = { m_pointer, split[1] };
+
+        return split[0] + split[1];
+    }
+
+    // Prepare로 받은 공간에 기록된 만큼 기록 위치를 옮긴다.
+    void Commit(const int32_t t_length)
+    {
+        if (0 >= t_length)
         {
-            return true;
+            return;
         }
 
-        return false;
+        if (IsEmpty())
+        {
+            m_front = 0;
+            m_rear = 0;
+        }
+
+        m_rear = (m_rear + t_length) % m_capacity;
+    }
+
+    // 비어 있을 때만 t_capacity 크기로 줄인다.(큰 수신 이후 유휴 세션의 메모리를 돌려준다.)
+    void Shrink(const int32_t t_capacity)
+    {
+        int32_t capacity = std::max(t_capacity, DefaultCapacity);
+        if (false == IsEmpty() || m_capacity <= capacity)
+        {
+            return;
+        }
+
+        delete[] m_pointer;
+
+        m_pointer = new uint8_t[capacity];
+        m_capacity = capacity;
+    }
+
+    // 남은 데이터를 버린다.(용량은 유지한다.)
+    void Clear()
+    {
+        m_front = INITIAL_VALUE;
+        m_rear = INITIAL_VALUE;
+    }
+
+    inline int32_t GetCapacity() const
+    {
+        return m_capacity;
     }
 
     // Check if the queue is empty
@@ -88,9 +168,8 @@ public:
     void Write(const uint8_t* t_data, const int32_t t_length)
     {
         // 공간이 부족하다면 여기서 충분히 할당하도록 한다.
-        if (IsFull(t_length))
+        while (IsFull(t_length))
         {
-            std::cout << "Queue is full" << std::endl;
             Grow();
         }
 
@@ -300,41 +379,51 @@ public:
 private:
     void Grow()
     {
-        int32_t capacity = m_capacity << 1; // 2배!! 엄청 증가하지 않겠지.... 모니터링 필요함.
+        // 2배!! 엄청 증가하지 않겠지.... 모니터링 필요함.
+        if (MAX_CAPACITY / 2 < m_capacity)
+        {
+            throw std::length_error("StreamBuffer capacity overflow");
+        }
+
+        int32_t capacity = m_capacity << 1;
 
         uint8_t* buffer = new uint8_t[capacity];
         
         // 가장 앞으로정렬 시킨다.
-        std::array<int, 2> split;
-        if (m_front < m_rear)
-        {
-            split[0] = m_rear - m_front;
-            split[1] = 0;
-        }
-        else
-        {
-            split[0] = m_capacity - m_front;
-            split[1] = m_rear;
-        }
-
         int32_t offset = 0;
-        for (auto& n : split)
+        if (false == IsEmpty())
         {
-            if (n <= 0)
-                break;
+            std::array<int, 2> split;
+            if (m_front < m_rear)
+            {
+                split[0] = m_rear - m_front;
+                split[1] = 0;
+            }
+            else
+            {
+                split[0] = m_capacity - m_front;
+                split[1] = m_rear;
+            }
 
-            memcpy(buffer + offset, m_pointer + m_front, n);
-            offset += n;
-            m_front = (m_front + n) % capacity;
+            for (auto& n : split)
+            {
+                if (n <= 0)
+                    break;
+
+                memcpy(buffer + offset, m_pointer + m_front, n);
+                offset += n;
+                m_front = (m_front + n) % m_capacity;
+            }
+
+            m_front = 0;
+            m_rear = offset % capacity;
         }
 
-        m_front = 0;
-        m_rear = offset % capacity;
         m_capacity = capacity;
         
         if (nullptr != m_pointer)
         {
-            delete m_pointer;
+            delete[] m_pointer;
             m_pointer = nullptr;
         }
 
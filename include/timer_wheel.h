@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <boost/noncopyable.hpp>
+
+namespace net
+{
+// 계층형 타이밍 휠(io 워커마다 하나)
+// - 레벨마다 SLOTS개의 슬롯을 두고, 만료까지 남은 tick에 따라 레벨을 정한다.(레벨 0 : 64tick, 1 : 4096tick ...)
+// - 상위 레벨의 슬롯은 차례가 되면 하위 레벨로 옮겨지며(cascade), 레벨 0의 슬롯에서 만료된다.
+// - 항목(Node)은 소유자의 멤버로 두는 intrusive 리스트이므로 Schedule/Cancel은 O(1)이고 할당이 없다.
+// - 최대 범위(SLOTS ^ LEVELS tick)를 넘는 만료는 범위 끝에서 만료되므로, 소유자가 남은 시간을 확인하고 다시 건다.
+// - SHARED 모델에서는 여러 스레드가 같은 휠을 사용하므로 lock으로 보호한다.(PER_THREAD 모델에서는 경쟁이 없다.)
+class TimerWheel : private boost::noncopyable
+{
+public:
+	static constexpr uint32_t SLOT_BITS = 6;
+	static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+	static constexpr uint32_t LEVELS = 4;
+	static constexpr uint64_t MAX_TICKS = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+	static constexpr std::chrono::milliseconds TICK{ 10 };
+
+	// 휠에 거는 항목
+	class Node : private boost::noncopyable
+	{
+	public:
+		virtual ~Node() = default;
+
+		// 만료되었다.(휠의 lock 안에서 호출되므로 휠 함수를 호출하면 안된다.)
+		virtual void OnExpire() = 0;
+
+	private:
+		friend class TimerWheel;
+
+		Node* m_prev = nullptr;
+		Node* m_next = nullptr;
+		uint64_t m_expire = 0;
+
+		// 걸려 있는 휠(nullptr이면 걸려 있지 않다.)
+		std::atomic<TimerWheel*> m_wheel{ nullptr };
+	};
+
+	TimerWheel() = default;
+
+	// 남은 항목은 떼어내기만 하고 만료시키지 않는다.
+	~TimerWheel();
+
+	// 현재 tick(다른 스레드에서 읽을 수 있다.)
+	inline uint64_t GetTick() const
+	{
+		return m_tick.load(std::memory_order_relaxed);
+	}
+
+	// msec를 tick으로 올림한다.
+	static inline uint64_t ToTicks(const uint32_t t_msec)
+	{
+		return (static_cast<uint64_t>(t_msec) + TICK.count() - 1) / TICK.count();
+	}
+
+	static inline uint64_t ToMilliseconds(const uint64_t t_ticks)
+	{
+		return t_ticks * TICK.count();
+	}
+
+	// t_expire tick에 만료되도록 건다.(이미 걸려 있으면 옮긴다, 현재 tick 이전이면 다음 tick에 만료된다.)
+	void Schedule(Node& t_node, const uint64_t t_expire);
+
+	// 걸려 있지 않으면 아무것도 하지 않는다.(휠이 먼저 해제되었어도 호출할 수 있다.)
+	static void Cancel(Node& t_node);
+
+	// t_tick까지 한 tick씩 진행하면서 만료된 항목의 OnExpire를 호출한다.
+	void Advance(const uint64_t t_tick);
+
+	inline std::size_t GetSize()
+	{
+		std::lock_guard lock(m_mutex);
+		return m_size;
+	}
+
+private:
+	using _slot_t = Node*;
+	using _level_t = std::array<_slot_t, SLOTS>;
+
+	// 아래 함수는 lock 안에서 호출한다.
+	void Link(Node& t_node);
+	void Unlink(Node& t_node);
+
+	// t_level의 현재 슬롯을 아래 레벨로 옮긴다.
+	void Cascade(const uint32_t t_level);
+
+	static inline uint32_t GetIndex(const uint64_t t_tick, const uint32_t t_level)
+	{
+		return static_cast<uint32_t>((t_tick >> (SLOT_BITS * t_level)) & (SLOTS - 1));
+	}
+
+	std::mutex m_mutex;
+	std::array<_level_t, LEVELS> m_levels{};
+	std::size_t m_size = 0;
+
+	// 마지막으로 처리한 tick
+	std::atomic<uint64_t> m_tick{ 0 };
+};
+}
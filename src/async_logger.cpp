@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include "async_logger.h"
+
+namespace net
+{
+namespace
+{
+void AppendNumber(std::string& t_text, const int64_t t_value, const int32_t t_width = 0)
+{
+	char buffer[24];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), t_value);
+
+	std::size_t length = static_cast<std::size_t>(result.ptr - buffer);
+	if (static_cast<std::size_t>(t_width) > length)
+	{
+		t_text.append(t_width - length, '0');
+	}
+	t_text.append(buffer, length);
+}
+
+// [HH:MM:SS.uuuuuu] (로컬 시간)
+void AppendTime(std::string& t_text, const uint64_t t_time)
+{
+	std::time_t seconds = static_cast<std::time_t>(t_time / 1000000000ull);
+
+	std::tm local{};
+#ifdef _WIN32
+	localtime_s(&local, &seconds);
+#else
+	localtime_r(&seconds, &local);
+#endif
+
+	t_text += '[';
+	AppendNumber(t_text, local.tm_hour, 2);
+	t_text += ':';
+	AppendNumber(t_text, local.tm_min, 2);
+	t_text += ':';
+	AppendNumber(t_text, local.tm_sec, 2);
+	t_text += '.';
+	AppendNumber(t_text, static_cast<int64_t>((t_time / 1000ull) % 1000000ull), 6);
+	t_text += "] ";
+}
+}
+
+#pragma region R_ASYNC_LOGGER
+AsyncLogger::ThreadRing::ThreadRing(AsyncLogger& t_logger)
+	: ring(new Ring())
+{
+	std::lock_guard lock(t_logger.m_mutex);
+	t_logger.m_rings.push_back(ring);
+}
+
+AsyncLogger::ThreadRing::~ThreadRing()
+{
+	// 남은 레코드는 로그 스레드가 비운 뒤 해제한다.
+	ring->retired.store(true, std::memory_order_release);
+}
+
+AsyncLogger& AsyncLogger::Instance()
+{
+	static AsyncLogger logger;
+	return logger;
+}
+
+AsyncLogger::AsyncLogger()
+{
+	m_message.reserve(MAX_MESSAGE_LENGTH);
+	m_line.reserve(MAX_MESSAGE_LENGTH + 256);
+
+	m_thread = std::thread([this]() {
+		Run();
+		}
+	);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	if (true == m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	for (auto ring : m_rings)
+	{
+		Drain(*ring);
+		delete ring;
+	}
+	m_rings.clear();
+}
+
+AsyncLogger::Ring& AsyncLogger::GetThreadRing()
+{
+	static thread_local ThreadRing threadRing(*this);
+	return *threadRing.ring;
+}
+
+bool AsyncLogger::Write(ILogging* t_sink, const eLogLevel& t_level, const char* t_function, const int32_t t_line, const std::string_view t_message, const boost::system::error_code* t_errorCode)
+{
+	Ring& ring = GetThreadRing();
+
+	std::size_t length = std::min(t_message.size(), MAX_MESSAGE_LENGTH);
+	uint64_t count = std::max<uint64_t>((length + LogRecord::MESSAGE_SIZE - 1) / LogRecord::MESSAGE_SIZE, 1);
+
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	if (RING_CAPACITY < head - ring.tail.load(std::memory_order_acquire) + count)
+	{
+		++ring.dropped;
+		return false;
+	}
+
+	LogRecord& first = ring.records[head & (RING_CAPACITY - 1)];
+	first.time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+	first.sink = t_sink;
+	first.function = t_function;
+	first.line = t_line;
+	first.category = (nullptr == t_errorCode) ? nullptr : &t_errorCode->category();
+	first.errorValue = (nullptr == t_errorCode) ? 0 : t_errorCode->value();
+	first.dropped = ring.dropped;
+	first.level = static_cast<uint8_t>(t_level);
+
+	ring.dropped = 0;
+
+	std::size_t offset = 0;
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		LogRecord& record = ring.records[(head + i) & (RING_CAPACITY - 1)];
+
+		std::size_t size = std::min(length - offset, LogRecord::MESSAGE_SIZE);
+		memcpy(record.message, t_message.data() + offset, size);
+		record.length = static_cast<uint16_t>(size);
+		record.continued = (i + 1 < count) ? 1 : 0;
+
+		offset += size;
+	}
+
+	ring.head.store(head + count, std::memory_order_release);
+
+	return true;
+}
+
+void AsyncLogger::Flush()
+{
+	std::unique_lock lock(m_mutex);
+
+	uint64_t request = ++m_flushRequested;
+	m_condition.notify_all();
+
+	m_flushed.wait(lock, [this, request]() {
+		return (request <= m_flushCompleted || true == m_stopping);
+		}
+	);
+}
+
+void AsyncLogger::Run()
+{
+	std::unique_lock lock(m_mutex);
+
+	while (true)
+	{
+		m_condition.wait_for(lock, DRAIN_INTERVAL, [this]() {
+			return (true == m_stopping || m_flushCompleted < m_flushRequested);
+			}
+		);
+
+		if (true == m_stopping)
+		{
+			break;
+		}
+
+		uint64_t request = m_flushRequested;
+		std::vector<Ring*> rings = m_rings;
+
+		lock.unlock();
+
+		std::vector<Ring*> retired;
+		for (auto ring : rings)
+		{
+			// 종료 표시를 먼저 확인해야 비운 뒤 남은 레코드가 없다.
+			bool isRetired = ring->retired.load(std::memory_order_acquire);
+
+			Drain(*ring);
+
+			if (true == isRetired)
+			{
+				retired.push_back(ring);
+			}
+		}
+
+		lock.lock();
+
+		for (auto ring : retired)
+		{
+			m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring), m_rings.end());
+			delete ring;
+		}
+
+		m_flushCompleted = request;
+		m_flushed.notify_all();
+	}
+
+	m_flushed.notify_all();
+}
+
+void AsyncLogger::Drain(Ring& t_ring)
+{
+	uint64_t tail = t_ring.tail.load(std::memory_order_relaxed);
+	uint64_t head = t_ring.head.load(std::memory_order_acquire);
+
+	const LogRecord* first = nullptr;
+	for (; tail < head; ++tail)
+	{
+		const LogRecord& record = t_ring.records[tail & (RING_CAPACITY - 1)];
+		if (nullptr == first)
+		{
+			first = &record;
+			m_message.clear();
+		}
+
+		m_message.append(record.message, record.length);
+
+		if (0 == record.continued)
+		{
+			Deliver(*first, m_message);
+			first = nullptr;
+		}
+	}
+
+	t_ring.tail.store(tail, std::memory_order_release);
+}
+
+void AsyncLogger::Deliver(const LogRecord& t_record, const std::string_view t_message)
+{
+	if (nullptr == t_record.sink)
+	{
+		return;
+	}
+
+	m_line.clear();
+
+	AppendTime(m_line, t_record.time);
+
+	m_line += '[';
+	m_line += (nullptr == t_record.function) ? "" : t_record.function;
+	m_line += '(';
+	AppendNumber(m_line, t_record.line);
+	m_line += ")] ";
+	m_line.append(t_message);
+
+	if (nullptr != t_record.category)
+	{
+		if (false == t_message.empty())
+		{
+			m_line += ' ';
+		}
+
+		m_line += t_record.category->name();
+		m_line += ':';
+		AppendNumber(m_line, t_record.errorValue);
+		m_line += " message=";
+		m_line += t_record.category->message(t_record.errorValue);
+	}
+
+	if (0 < t_record.dropped)
+	{
+		m_line += " (dropped ";
+		AppendNumber(m_line, t_record.dropped);
+		m_line += ')';
+	}
+
+	switch (static_cast<eLogLevel>(t_record.level))
+	{
+	case eLogLevel::TRACE:
+		t_record.sink->Trace(m_line);
+		break;
+
+	case eLogLevel::DEBUG:
+		t_record.sink->Debug(m_line);
+		break;
+
+	case eLogLevel::INFO:
+		t_record.sink->Info(m_line);
+		break;
+
+	case eLogLevel::WARN:
+		t_record.sink->Warnning(m_line);
+		break;
+
+	case eLogLevel::ERR:
+		t_record.sink->Error(m_line);
+		break;
+
+	default:
+		break;
+	}
+}
+#pragma endregion R_ASYNC_LOGGER
+}
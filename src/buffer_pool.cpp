@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include "buffer_pool.h"
+#include "cpu_topology.h"
+
+namespace net
+{
+namespace
+{
+inline void AddCounter(std::atomic<uint64_t>& t_counter, const uint64_t t_value)
+{
+	t_counter.store(t_counter.load(std::memory_order_relaxed) + t_value, std::memory_order_relaxed);
+}
+}
+
+#pragma region R_BUFFER_POOL
+BufferPool::ThreadCache::ThreadCache(BufferPool& t_pool)
+	: pool(t_pool)
+{
+	int32_t cpu = CpuTopology::GetCurrentCpu();
+	int32_t cpuNode = (0 <= cpu) ? CpuTopology::Instance().GetNode(static_cast<uint32_t>(cpu)) : -1;
+	node = (0 <= cpuNode) ? static_cast<uint32_t>(cpuNode) : 0;
+
+	for (uint32_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+	{
+		blocks[i].reserve(GetCacheLimit(i) + 1);
+	}
+
+	pool.Register(this);
+}
+
+BufferPool::ThreadCache::~ThreadCache()
+{
+	// 스레드가 종료되면 보관 중인 블록을 공용 목록으로 돌려준다.
+	for (uint32_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+	{
+		pool.Flush(*this, i, blocks[i].size());
+	}
+
+	pool.Unregister(this);
+}
+
+BufferPool& BufferPool::Instance()
+{
+	static BufferPool pool;
+	return pool;
+}
+
+BufferPool::BufferPool()
+	: m_centrals(std::max<uint32_t>(CpuTopology::Instance().GetNodeCount(), 1))
+{
+}
+
+BufferPool::~BufferPool()
+{
+	for (auto& centrals : m_centrals)
+	{
+		for (auto& central : centrals)
+		{
+			for (auto block : central.blocks)
+			{
+				::operator delete(block);
+			}
+			central.blocks.clear();
+		}
+	}
+}
+
+uint32_t BufferPool::GetClass(const std::size_t& t_size)
+{
+	if (GetClassSize(0) >= t_size)
+	{
+		return 0;
+	}
+
+	uint32_t bits = static_cast<uint32_t>(std::bit_width(t_size - 1));
+	if (MAX_CLASS_BITS < bits)
+	{
+		return OVERSIZE;
+	}
+
+	return bits - MIN_CLASS_BITS;
+}
+
+std::size_t BufferPool::RoundUp(const std::size_t& t_size)
+{
+	uint32_t sizeClass = GetClass(t_size);
+	if (OVERSIZE == sizeClass)
+	{
+		return t_size;
+	}
+
+	return GetClassSize(sizeClass);
+}
+
+void* BufferPool::Allocate(const std::size_t& t_size)
+{
+	ThreadCache& cache = GetThreadCache();
+
+	uint32_t sizeClass = GetClass(t_size);
+	if (OVERSIZE == sizeClass)
+	{
+		AddCounter(cache.misses, 1);
+		return ::operator new(t_size);
+	}
+
+	auto& blocks = cache.blocks[sizeClass];
+	if (true == blocks.empty())
+	{
+		Refill(cache, sizeClass, GetCacheLimit(sizeClass) / 2);
+	}
+
+	if (false == blocks.empty())
+	{
+		AddCounter(cache.hits, 1);
+
+		void* block = blocks.back();
+		blocks.pop_back();
+		return block;
+	}
+
+	// 공용 목록도 비었으면 Refill과 같은 수만큼 새로 만들어 둔다.(misses는 새로 만든 블록 수로 센다.)
+	// 하나씩 만들면 스레드 사이를 오가는 블록(공유 io_context)이 반납하는 쪽 캐시에 한도만큼 쌓일 때까지 계속 할당하게 된다.
+	const std::size_t size = GetClassSize(sizeClass);
+	const std::size_t count = std::max<std::size_t>(GetCacheLimit(sizeClass) / 2, 1);
+	AddCounter(cache.misses, count);
+
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		blocks.push_back(::operator new(size));
+	}
+	return ::operator new(size);
+}
+
+void BufferPool::Release(void* t_pointer, const std::size_t& t_size)
+{
+	if (nullptr == t_pointer)
+	{
+		return;
+	}
+
+	uint32_t sizeClass = GetClass(t_size);
+	if (OVERSIZE == sizeClass)
+	{
+		::operator delete(t_pointer);
+		return;
+	}
+
+	ThreadCache& cache = GetThreadCache();
+
+	auto& blocks = cache.blocks[sizeClass];
+	blocks.push_back(t_pointer);
+
+	std::size_t limit = GetCacheLimit(sizeClass);
+	if (limit < blocks.size())
+	{
+		Flush(cache, sizeClass, limit / 2);
+	}
+}
+
+void BufferPool::SetThreadNode(const uint32_t t_node)
+{
+	ThreadCache& cache = GetThreadCache();
+
+	uint32_t node = (t_node < m_centrals.size()) ? t_node : 0;
+	if (node == cache.node)
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < NUMBER_OF_CLASSES; ++i)
+	{
+		Flush(cache, i, cache.blocks[i].size());
+	}
+
+	cache.node = node;
+}
+
+void BufferPool::GetStats(BufferPoolStats& t_stats)
+{
+	std::lock_guard lock(m_mutex);
+
+	t_stats.hits = m_retiredHits;
+	t_stats.misses = m_retiredMisses;
+	for (auto cache : m_threadCaches)
+	{
+		t_stats.hits += cache->hits.load(std::memory_order_relaxed);
+		t_stats.misses += cache->misses.load(std::memory_order_relaxed);
+	}
+}
+
+BufferPool::ThreadCache& BufferPool::GetThreadCache()
+{
+	static thread_local ThreadCache cache(*this);
+	return cache;
+}
+
+void BufferPool::Refill(ThreadCache& t_cache, const uint32_t t_class, const std::size_t t_count)
+{
+	Central& central = m_centrals[t_cache.node][t_class];
+	auto& blocks = t_cache.blocks[t_class];
+
+	std::lock_guard lock(central.mutex);
+
+	std::size_t count = std::min(t_count, central.blocks.size());
+	blocks.insert(blocks.end(), central.blocks.end() - count, central.blocks.end());
+	central.blocks.resize(central.blocks.size() - count);
+}
+
+void BufferPool::Flush(ThreadCache& t_cache, const uint32_t t_class, const std::size_t t_count)
+{
+	Central& central = m_centrals[t_cache.node][t_class];
+	auto& blocks = t_cache.blocks[t_class];
+
+	std::size_t count = std::min(t_count, blocks.size());
+	if (0 == count)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock(central.mutex);
+		central.blocks.insert(central.blocks.end(), blocks.end() - count, blocks.end());
+	}
+
+	blocks.resize(blocks.size() - count);
+}
+
+void BufferPool::Register(ThreadCache* t_cache)
+{
+	std::lock_guard lock(m_mutex);
+	m_threadCaches.push_back(t_cache);
+}
+
+void BufferPool::Unregister(ThreadCache* t_cache)
+{
+	std::lock_guard lock(m_mutex);
+
+	m_retiredHits += t_cache->hits.load(std::memory_order_relaxed);
+	m_retiredMisses += t_cache->misses.load(std::memory_order_relaxed);
+
+	m_threadCaches.erase(std::remove(m_threadCaches.begin(), m_threadCaches.end(), t_cache), m_threadCaches.end());
+}
+#pragma endregion R_BUFFER_POOL
+
+#pragma region R_POOLED_WRITE_BUFFER
+PooledWriteBuffer::PooledWriteBuffer(const std::size_t& t_capacity)
+	: m_capacity(BufferPool::RoundUp(RESERVED_SPACE_SIZE + t_capacity))
+	, m_pointer(static_cast<uint8_t*>(BufferPool::Instance().Allocate(m_capacity)))
+{
+}
+
+PooledWriteBuffer::~PooledWriteBuffer()
+{
+	BufferPool::Instance().Release(m_pointer, m_capacity);
+	m_pointer = nullptr;
+}
+
+size_t PooledWriteBuffer::Put(const void* t_data, const size_t& t_length)
+{
+	if (m_capacity < (m_offset + t_length))
+	{
+		Grow(m_offset + t_length);
+	}
+
+	memcpy(m_pointer + m_offset, t_data, t_length);
+
+	m_offset += t_length;
+
+	return 0;
+}
+
+void PooledWriteBuffer::Commit()
+{
+	int32_t dataLength = static_cast<int32_t>(m_offset - RESERVED_SPACE_SIZE);
+	memcpy(m_pointer, &dataLength, sizeof(dataLength));
+}
+
+void PooledWriteBuffer::Grow(const std::size_t& t_length)
+{
+	// 예상 크기를 넘은 경우에만 다음 크기의 블록으로 옮긴다.
+	std::size_t capacity = BufferPool::RoundUp(std::max(t_length, m_capacity << 1));
+	uint8_t* pointer = static_cast<uint8_t*>(BufferPool::Instance().Allocate(capacity));
+
+	memcpy(pointer, m_pointer, m_offset);
+
+	BufferPool::Instance().Release(m_pointer, m_capacity);
+
+	m_pointer = pointer;
+	m_capacity = capacity;
+}
+#pragma endregion R_POOLED_WRITE_BUFFER
+}
@@ -0,0 +1,282 @@
+#include <utility>
+#include <boost/asio/error.hpp>
+#include "co_session.h"
+
+namespace net
+{
+#pragma region R_CO_TASK
+CoTask::promise_type::promise_type(CoSession& t_session)
+	: session(t_session)
+{
+	session.m_running = true;
+}
+
+CoTask::promise_type::~promise_type()
+{
+	session.m_running = false;
+
+	// 연결이 먼저 끊어졌으면 여기서 해제한다.
+	if (true == session.m_closed && false == session.m_listener->m_destroying)
+	{
+		session.m_listener->Remove(session.m_sid);
+	}
+}
+#pragma endregion R_CO_TASK
+
+#pragma region R_CO_SESSION
+bool CoSession::WriteAwaiter::await_suspend(std::coroutine_handle<> t_handle)
+{
+	if (true == m_session.m_closed)
+	{
+		m_result = eWriteResult::NOT_FOUND;
+		return false;
+	}
+
+	m_result = m_session.m_controller->Write(m_session.m_sid, m_buffer);
+	if (eWriteResult::WOULD_BLOCK != m_result)
+	{
+		return false;
+	}
+
+	// OnWritable에서 다시 쓴 뒤 재개한다.
+	m_session.m_writer = t_handle;
+	m_session.m_writeBuffer = &m_buffer;
+	m_session.m_writeResult = &m_result;
+	return true;
+}
+
+CoSession::CoSession(const _sid_t& t_sid, IController* t_controller, CoListener* t_listener)
+	: m_sid(t_sid)
+	, m_controller(t_controller)
+	, m_listener(t_listener)
+{
+}
+
+CoSession::~CoSession()
+{
+	// 재개되지 않은 프레임(CoListener 해제 시)
+	if (m_reader)
+	{
+		std::exchange(m_reader, nullptr).destroy();
+	}
+	else if (m_writer)
+	{
+		std::exchange(m_writer, nullptr).destroy();
+	}
+}
+
+void CoSession::OnMessage(const uint8_t* t_data, const std::size_t& t_len)
+{
+	if (m_reader)
+	{
+		// 기다리는 코루틴은 수신 버퍼를 그대로 넘겨서 재개한다.
+		m_received = std::span<const uint8_t>(t_data, t_len);
+		Resume(m_reader);
+		return;
+	}
+
+	m_pending.push_back(MessageBuffer::Copy(t_data, t_len));
+
+	if (false == m_readPaused && MAX_PENDING_MESSAGES <= m_pending.size())
+	{
+		m_readPaused = m_controller->PauseRead(m_sid);
+	}
+}
+
+void CoSession::OnWritable()
+{
+	if (!m_writer)
+	{
+		return;
+	}
+
+	*m_writeResult = m_controller->Write(m_sid, *m_writeBuffer);
+	if (eWriteResult::WOULD_BLOCK == *m_writeResult)
+	{
+		return;
+	}
+
+	m_writeBuffer = nullptr;
+	m_writeResult = nullptr;
+	Resume(m_writer);
+}
+
+void CoSession::OnClose(const boost::system::error_code& t_errorCode)
+{
+	m_closed = true;
+	m_closeError = t_errorCode;
+
+	if (m_writer)
+	{
+		*m_writeResult = eWriteResult::NOT_FOUND;
+		m_writeBuffer = nullptr;
+		m_writeResult = nullptr;
+		Resume(m_writer);
+	}
+	else if (m_reader)
+	{
+		Resume(m_reader);
+	}
+}
+
+CoMessage CoSession::TakeMessage()
+{
+	CoMessage message;
+
+	if (nullptr != m_received.data())
+	{
+		message.data = std::exchange(m_received, std::span<const uint8_t>());
+		return message;
+	}
+
+	if (false == m_pending.empty())
+	{
+		m_current = std::move(m_pending.front());
+		m_pending.pop_front();
+
+		if (true == m_readPaused && true == m_pending.empty())
+		{
+			m_controller->ResumeRead(m_sid);
+			m_readPaused = false;
+		}
+
+		message.data = std::span<const uint8_t>(m_current->GetData(), m_current->GetLength());
+		return message;
+	}
+
+	m_current.reset();
+
+	message.errorCode = m_closeError ? m_closeError : boost::asio::error::make_error_code(boost::asio::error::eof);
+	return message;
+}
+
+void CoSession::Resume(std::coroutine_handle<>& t_handle)
+{
+	// 재개 중에 다시 기다릴 수 있으므로 먼저 비운다.(코루틴이 끝나면 이 객체가 해제될 수 있다.)
+	std::exchange(t_handle, nullptr).resume();
+}
+#pragma endregion R_CO_SESSION
+
+#pragma region R_CO_LISTENER
+CoListener::CoListener(IController* t_controller, _handler_t&& t_handler)
+	: m_controller(t_controller)
+	, m_handler(std::move(t_handler))
+{
+}
+
+CoListener::~CoListener()
+{
+	m_destroying = true;
+
+	for (auto& shard : m_shards)
+	{
+		std::lock_guard lock(shard.mutex);
+		shard.sessions.clear();
+	}
+}
+
+void CoListener::OnConnected(const _sid_t& sid)
+{
+	CoSession* session = new CoSession(sid, m_controller, this);
+	{
+		Shard& shard = GetShard(sid);
+
+		std::lock_guard lock(shard.mutex);
+		shard.sessions[sid].reset(session);
+	}
+
+	m_handler(*session);
+}
+
+void CoListener::OnClose(const _sid_t& sid, const boost::system::error_code& t_errorCode)
+{
+	CoSession* session = Find(sid);
+	if (nullptr == session)
+	{
+		return;
+	}
+
+	session->OnClose(t_errorCode);
+
+	// 코루틴이 이미 끝났으면 바로 해제하고, 아니면 끝날 때 해제한다.(promise_type)
+	// 재개한 코루틴이 끝나면서 해제했을 수 있으므로 다시 찾는다.
+	session = Find(sid);
+	if (nullptr != session && false == session->m_running)
+	{
+		Remove(sid);
+	}
+}
+
+void CoListener::OnMessage(const _sid_t& sid, const uint8_t* data, const std::size_t& len)
+{
+	CoSession* session = Find(sid);
+	if (nullptr == session)
+	{
+		return;
+	}
+
+	session->OnMessage(data, len);
+}
+
+void CoListener::OnError(const _sid_t& /*sid*/, const boost::system::error_code& /*t_errorCode*/)
+{
+	// 연결 실패(세션이 시작되지 않아 코루틴이 없다.)
+}
+
+void CoListener::OnWritable(const _sid_t& sid)
+{
+	CoSession* session = Find(sid);
+	if (nullptr == session)
+	{
+		return;
+	}
+
+	session->OnWritable();
+}
+
+std::size_t CoListener::GetSize()
+{
+	std::size_t size = 0;
+	for (auto& shard : m_shards)
+	{
+		std::lock_guard lock(shard.mutex);
+		size += shard.sessions.size();
+	}
+	return size;
+}
+
+CoSession* CoListener::Find(const _sid_t& t_sid)
+{
+	Shard& shard = GetShard(t_sid);
+
+	std::lock_guard lock(shard.mutex);
+
+	auto iter = shard.sessions.find(t_sid);
+	if (shard.sessions.end() == iter)
+	{
+		return nullptr;
+	}
+
+	return iter->second.get();
+}
+
+void CoListener::Remove(const _sid_t& t_sid)
+{
+	std::unique_ptr<CoSession> session;
+	{
+		Shard& shard = GetShard(t_sid);
+
+		std::lock_guard lock(shard.mutex);
+
+		auto iter = shard.sessions.find(t_sid);
+		if (shard.sessions.end() == iter)
+		{
+			return;
+		}
+
+		session = std::move(iter->second);
+		shard.sessions.erase(iter);
+	}
+}
+#pragma endregion R_CO_LISTENER
+}
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "cpu_topology.h"
+
+namespace net
+{
+namespace
+{
+#ifdef _WIN32
+// 그룹 0의 CPU만 사용한다.
+constexpr uint32_t MAX_MASK_CPUS = 64;
+
+_cpu_list_t FromMask(const ULONGLONG t_mask)
+{
+	_cpu_list_t cpus;
+	for (uint32_t cpu = 0; cpu < MAX_MASK_CPUS; ++cpu)
+	{
+		if (0 != (t_mask & (ULONGLONG(1) << cpu)))
+		{
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+// Windows는 스레드 affinity를 읽는 함수가 없으므로 마지막으로 설정한 값을 기억한다.
+thread_local _cpu_list_t s_threadAffinity;
+#endif
+
+#ifdef __linux__
+bool ReadNodeCpus(const std::filesystem::path& t_path, _cpu_list_t& t_cpus)
+{
+	std::ifstream file(t_path / "cpulist");
+	std::string text;
+	if (false == file.is_open() || !std::getline(file, text))
+	{
+		return false;
+	}
+
+	return CpuTopology::Parse(text, t_cpus);
+}
+#endif
+}
+
+#pragma region R_CPU_TOPOLOGY
+const CpuTopology& CpuTopology::Instance()
+{
+	static CpuTopology topology;
+	return topology;
+}
+
+CpuTopology::CpuTopology()
+{
+	_cpu_list_t available;
+	std::vector<std::pair<uint32_t, _cpu_list_t>> nodes;
+
+#ifdef _WIN32
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	if (FALSE != GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+	{
+		available = FromMask(processMask);
+	}
+
+	ULONG highestNode = 0;
+	if (FALSE != GetNumaHighestNodeNumber(&highestNode))
+	{
+		for (ULONG node = 0; node <= highestNode; ++node)
+		{
+			ULONGLONG mask = 0;
+			if (FALSE != GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask))
+			{
+				nodes.emplace_back(static_cast<uint32_t>(node), FromMask(mask));
+			}
+		}
+	}
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (0 == sched_getaffinity(0, sizeof(set), &set))
+	{
+		for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &set))
+			{
+				available.push_back(cpu);
+			}
+		}
+	}
+
+	std::error_code errorCode;
+	for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", errorCode))
+	{
+		std::string name = entry.path().filename().string();
+		if (0 != name.rfind("node", 0) || 4 == name.size() || std::string::npos != name.find_first_not_of("0123456789", 4))
+		{
+			continue;
+		}
+
+		_cpu_list_t cpus;
+		if (true == ReadNodeCpus(entry.path(), cpus))
+		{
+			nodes.emplace_back(static_cast<uint32_t>(std::stoul(name.substr(4))), std::move(cpus));
+		}
+	}
+#endif
+
+	if (true == available.empty())
+	{
+		for (uint32_t cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); ++cpu)
+		{
+			available.push_back(cpu);
+		}
+	}
+
+	// 노드 정보가 없으면 하나의 노드로 본다.
+	if (true == nodes.empty())
+	{
+		nodes.emplace_back(0, available);
+	}
+
+	std::sort(nodes.begin(), nodes.end());
+
+	uint32_t maxCpu = *std::max_element(available.begin(), available.end());
+	m_cpuNodes.assign(maxCpu + 1, -1);
+	m_nodeCpus.resize(nodes.back().first + 1);
+
+	for (auto& [node, cpus] : nodes)
+	{
+		for (auto cpu : cpus)
+		{
+			if (true == std::binary_search(available.begin(), available.end(), cpu))
+			{
+				m_cpuNodes[cpu] = static_cast<int32_t>(node);
+				m_nodeCpus[node].push_back(cpu);
+			}
+		}
+
+		if (false == m_nodeCpus[node].empty())
+		{
+			m_nodes.push_back(node);
+			m_available.insert(m_available.end(), m_nodeCpus[node].begin(), m_nodeCpus[node].end());
+		}
+	}
+
+	// 허용된 CPU가 있는 노드가 없으면 하나의 노드로 본다.
+	if (true == m_nodes.empty())
+	{
+		m_nodes.push_back(0);
+		m_nodeCpus.assign(1, available);
+		m_cpuNodes.assign(maxCpu + 1, -1);
+		for (auto cpu : available)
+		{
+			m_cpuNodes[cpu] = 0;
+		}
+		m_available = available;
+		return;
+	}
+
+	// 노드에 속하지 않은 CPU
+	for (auto cpu : available)
+	{
+		if (-1 == m_cpuNodes[cpu])
+		{
+			m_available.push_back(cpu);
+		}
+	}
+}
+
+const _cpu_list_t& CpuTopology::GetNodeCpus(const uint32_t t_node) const
+{
+	static const _cpu_list_t empty;
+	return (t_node < m_nodeCpus.size()) ? m_nodeCpus[t_node] : empty;
+}
+
+int32_t CpuTopology::GetNode(const uint32_t t_cpu) const
+{
+	return (t_cpu < m_cpuNodes.size()) ? m_cpuNodes[t_cpu] : -1;
+}
+
+int32_t CpuTopology::GetNode(const _cpu_list_t& t_cpus) const
+{
+	int32_t node = -1;
+	for (auto cpu : t_cpus)
+	{
+		int32_t cpuNode = GetNode(cpu);
+		if (-1 == cpuNode || (-1 != node && node != cpuNode))
+		{
+			return -1;
+		}
+		node = cpuNode;
+	}
+	return node;
+}
+
+std::vector<_cpu_list_t> CpuTopology::Place(const eCpuPlacement t_placement, const uint32_t t_count) const
+{
+	std::vector<_cpu_list_t> cpuSets;
+
+	for (uint32_t i = 0; i < t_count; ++i)
+	{
+		switch (t_placement)
+		{
+		case eCpuPlacement::CORE:
+			// 노드 순서로 채운다.(CPU보다 워커가 많으면 처음부터 다시 배정한다.)
+			cpuSets.push_back(_cpu_list_t{ m_available[i % m_available.size()] });
+			break;
+
+		case eCpuPlacement::NUMA:
+			cpuSets.push_back(m_nodeCpus[m_nodes[i % m_nodes.size()]]);
+			break;
+
+		default:
+			return cpuSets;
+		}
+	}
+
+	return cpuSets;
+}
+
+bool CpuTopology::SetThreadAffinity(const _cpu_list_t& t_cpus)
+{
+	if (true == t_cpus.empty())
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	ULONGLONG mask = 0;
+	for (auto cpu : t_cpus)
+	{
+		if (MAX_MASK_CPUS <= cpu)
+		{
+			return false;
+		}
+		mask |= ULONGLONG(1) << cpu;
+	}
+
+	if (0 == SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)))
+	{
+		return false;
+	}
+
+	s_threadAffinity = FromMask(mask);
+	return true;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : t_cpus)
+	{
+		if (CPU_SETSIZE <= cpu)
+		{
+			return false;
+		}
+		CPU_SET(cpu, &set);
+	}
+
+	return 0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	return false;
+#endif
+}
+
+_cpu_list_t CpuTopology::GetThreadAffinity()
+{
+#ifdef _WIN32
+	return (false == s_threadAffinity.empty()) ? s_threadAffinity : Instance().GetAvailableCpus();
+#elif defined(__linux__)
+	_cpu_list_t cpus;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (0 == pthread_getaffinity_np(pthread_self(), sizeof(set), &set))
+	{
+		for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &set))
+			{
+				cpus.push_back(cpu);
+			}
+		}
+	}
+	return cpus;
+#else
+	return _cpu_list_t();
+#endif
+}
+
+int32_t CpuTopology::GetCurrentCpu()
+{
+#ifdef _WIN32
+	return static_cast<int32_t>(GetCurrentProcessorNumber());
+#elif defined(__linux__)
+	return sched_getcpu();
+#else
+	return -1;
+#endif
+}
+
+std::string CpuTopology::ToString(const _cpu_list_t& t_cpus)
+{
+	_cpu_list_t cpus(t_cpus);
+	std::sort(cpus.begin(), cpus.end());
+	cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+	std::string text;
+	for (std::size_t i = 0; i < cpus.size();)
+	{
+		// 연속된 번호는 범위로 묶는다.
+		std::size_t last = i;
+		while (last + 1 < cpus.size() && cpus[last] + 1 == cpus[last + 1])
+		{
+			++last;
+		}
+
+		if (false == text.empty())
+		{
+			text += ',';
+		}
+
+		text += std::to_string(cpus[i]);
+		if (last != i)
+		{
+			text += '-';
+			text += std::to_string(cpus[last]);
+		}
+
+		i = last + 1;
+	}
+	return text;
+}
+
+bool CpuTopology::Parse(const std::string& t_text, _cpu_list_t& t_cpus)
+{
+	t_cpus.clear();
+
+	std::size_t begin = 0;
+	while (begin < t_text.size())
+	{
+		std::size_t end = t_text.find(',', begin);
+		if (std::string::npos == end)
+		{
+			end = t_text.size();
+		}
+
+		std::string item = t_text.substr(begin, end - begin);
+		item.erase(std::remove_if(item.begin(), item.end(), [](const char t_char) { return ' ' == t_char || '\n' == t_char || '\r' == t_char; }), item.end());
+
+		begin = end + 1;
+		if (true == item.empty())
+		{
+			continue;
+		}
+
+		if (std::string::npos != item.find_first_not_of("0123456789-"))
+		{
+			return false;
+		}
+
+		std::size_t dash = item.find('-');
+		if (0 == dash || item.size() - 1 == dash || (std::string::npos != dash && std::string::npos != item.find('-', dash + 1)))
+		{
+			return false;
+		}
+
+		uint32_t first = static_cast<uint32_t>(std::stoul(item.substr(0, dash)));
+		uint32_t last = (std::string::npos == dash) ? first : static_cast<uint32_t>(std::stoul(item.substr(dash + 1)));
+		if (first > last)
+		{
+			return false;
+		}
+
+		for (uint32_t cpu = first; cpu <= last; ++cpu)
+		{
+			t_cpus.push_back(cpu);
+		}
+	}
+
+	return true;
+}
+#pragma endregion R_CPU_TOPOLOGY
+}
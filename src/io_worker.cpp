@@ -0,0 +1,226 @@
+#include "io_worker.h"
+#include "handler_memory.h"
+#include "cpu_topology.h"
+
+namespace net
+{
+ThroughputCounter* ThroughputCounter::Current()
+{
+	IoWorker* worker = IoWorker::Current();
+	if (nullptr == worker)
+	{
+		return nullptr;
+	}
+
+	return &worker->GetCounter();
+}
+
+eCloseReason ThroughputCounter::GetCloseReason(const boost::system::error_code& t_errorCode)
+{
+	if (!t_errorCode || boost::asio::error::eof == t_errorCode)
+	{
+		return eCloseReason::NORMAL;
+	}
+
+	if (boost::asio::error::connection_reset == t_errorCode
+		|| boost::asio::error::broken_pipe == t_errorCode
+		|| boost::asio::error::connection_aborted == t_errorCode)
+	{
+		return eCloseReason::RESET;
+	}
+
+	if (boost::asio::error::operation_aborted == t_errorCode)
+	{
+		return eCloseReason::ABORTED;
+	}
+
+	if (boost::asio::error::timed_out == t_errorCode)
+	{
+		return eCloseReason::TIMEOUT;
+	}
+
+	if (boost::asio::error::invalid_argument == t_errorCode
+		|| boost::asio::error::message_size == t_errorCode)
+	{
+		return eCloseReason::PROTOCOL;
+	}
+
+	return eCloseReason::OTHER;
+}
+
+IoWorker::IoWorker(const uint32_t t_index, _io_context_t& t_ioContext, const bool t_exclusive)
+	: m_index(t_index)
+	, m_exclusive(t_exclusive)
+	, m_ioContext(t_ioContext)
+	, m_tickTimer(t_ioContext)
+{
+	if (true == m_exclusive)
+	{
+		m_workGuard.emplace(boost::asio::make_work_guard(m_ioContext));
+	}
+}
+
+void IoWorker::Run()
+{
+	s_current = this;
+
+	ApplyPlacement();
+
+	if (true == m_exclusive && 0 < m_spinTime.count())
+	{
+		RunSpin();
+	}
+	else
+	{
+		m_ioContext.run();
+	}
+
+	s_current = nullptr;
+}
+
+void IoWorker::Stop()
+{
+	m_workGuard.reset();
+	m_ioContext.stop();
+}
+
+void IoWorker::GetPlacement(WorkerPlacement& t_placement) const
+{
+	t_placement.index = m_index;
+	t_placement.requested = m_requestedCpus;
+	t_placement.cpu = m_lastCpu.load(std::memory_order_relaxed);
+
+	std::lock_guard lock(m_placementMutex);
+	t_placement.cpus = m_cpus;
+	t_placement.node = m_node;
+	t_placement.pinned = m_pinned;
+}
+
+void IoWorker::ApplyPlacement()
+{
+	bool pinned = CpuTopology::SetThreadAffinity(m_requestedCpus);
+	_cpu_list_t cpus = CpuTopology::GetThreadAffinity();
+	int32_t node = CpuTopology::Instance().GetNode(cpus);
+
+	// 한 노드에 고정되었으면 이 스레드에서 반납한 블록은 그 노드의 공용 목록으로 돌려준다.
+	if (true == pinned && 0 <= node)
+	{
+		BufferPool::Instance().SetThreadNode(static_cast<uint32_t>(node));
+	}
+
+	m_lastCpu.store(CpuTopology::GetCurrentCpu(), std::memory_order_relaxed);
+
+	std::lock_guard lock(m_placementMutex);
+	m_cpus = std::move(cpus);
+	m_node = node;
+	m_pinned = pinned;
+}
+
+void IoWorker::RunSpin()
+{
+	using _clock_t = std::chrono::steady_clock;
+
+	auto toNs = [](const _clock_t::duration& t_duration) {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t_duration).count());
+	};
+
+	auto last = _clock_t::now();
+	auto idleBegin = last;	// 마지막으로 소켓 완료를 확인한 시각
+	uint64_t events = GetSpinEvents();
+
+	while (false == m_ioContext.stopped())
+	{
+		// 준비된 핸들러만 처리하고 reactor를 기다리지 않는다.
+		m_ioContext.poll();
+
+		// 소켓 완료가 있었으면 작업 시간, 없었으면 spin 시간으로 기록한다.
+		auto now = _clock_t::now();
+		uint64_t current = GetSpinEvents();
+		if (current != events)
+		{
+			ThroughputCounter::Add(m_counter.workTime, toNs(now - last));
+			idleBegin = now;
+			events = current;
+		}
+		else
+		{
+			ThroughputCounter::Add(m_counter.spinTime, toNs(now - last));
+		}
+
+		if (m_spinTime <= now - idleBegin)
+		{
+			// spin 시간 동안 작업이 없으면 블록한다.(깨어나서 처리한 첫 핸들러는 블록 시간에 포함된다.)
+			ThroughputCounter::Add(m_counter.blocks, 1);
+			m_ioContext.run_one();
+
+			auto wakeup = _clock_t::now();
+			ThroughputCounter::Add(m_counter.blockTime, toNs(wakeup - now));
+			now = wakeup;
+			idleBegin = wakeup;
+			events = GetSpinEvents();
+		}
+
+		last = now;
+	}
+}
+
+void IoWorker::WaitTick()
+{
+	// 밀리지 않도록 시작 시각 기준으로 다음 tick을 건다.
+	m_tickTimer.expires_at(m_timerWheelStart + TimerWheel::TICK * (m_timerWheel.GetTick() + 1));
+	m_tickTimer.async_wait(boost::asio::make_pool_alloc_handler([this](const boost::system::error_code& t_errorCode) {
+		HandleTick(t_errorCode);
+		})
+	);
+}
+
+void IoWorker::HandleTick(const boost::system::error_code& t_errorCode)
+{
+	if (boost::asio::error::operation_aborted == t_errorCode)
+	{
+		return;
+	}
+
+	m_lastCpu.store(CpuTopology::GetCurrentCpu(), std::memory_order_relaxed);
+
+	// 늦게 깨어났으면 지난 tick을 한번에 처리한다.
+	auto elapsed = std::chrono::steady_clock::now() - m_timerWheelStart;
+	m_timerWheel.Advance(static_cast<uint64_t>(elapsed / TimerWheel::TICK));
+
+	WaitTick();
+}
+
+void IoWorker::GetThroughput(Throughput& t_throughput) const
+{
+	t_throughput.index = m_index;
+	t_throughput.sessions = m_counter.sessions.load(std::memory_order_relaxed);
+	t_throughput.readCount = m_counter.readCount.load(std::memory_order_relaxed);
+	t_throughput.readBytes = m_counter.readBytes.load(std::memory_order_relaxed);
+	t_throughput.readFrames = m_counter.readFrames.load(std::memory_order_relaxed);
+	t_throughput.writeCount = m_counter.writeCount.load(std::memory_order_relaxed);
+	t_throughput.writeBytes = m_counter.writeBytes.load(std::memory_order_relaxed);
+	t_throughput.writeFrames = m_counter.writeFrames.load(std::memory_order_relaxed);
+	t_throughput.accepts = m_counter.accepts.load(std::memory_order_relaxed);
+	t_throughput.connects = m_counter.connects.load(std::memory_order_relaxed);
+	for (std::size_t i = 0; i < t_throughput.closes.size(); ++i)
+	{
+		t_throughput.closes[i] = m_counter.closes[i].load(std::memory_order_relaxed);
+	}
+	t_throughput.writeQueueDepth = static_cast<int64_t>(m_counter.writeQueueDepth.load(std::memory_order_relaxed));
+	t_throughput.writeQueueBytes = static_cast<int64_t>(m_counter.writeQueueBytes.load(std::memory_order_relaxed));
+	t_throughput.spinTime = m_counter.spinTime.load(std::memory_order_relaxed);
+	t_throughput.workTime = m_counter.workTime.load(std::memory_order_relaxed);
+	t_throughput.blockTime = m_counter.blockTime.load(std::memory_order_relaxed);
+	t_throughput.blocks = m_counter.blocks.load(std::memory_order_relaxed);
+}
+
+void IoWorker::MergeLatency([[maybe_unused]] _latency_histograms_t& t_histograms) const
+{
+#ifdef _USE_LATENCY_HISTOGRAM
+	for (std::size_t i = 0; i < t_histograms.size(); ++i)
+	{
+		t_histograms[i].Merge(m_latency[i]);
+	}
+#endif
+}
+}
@@ -206,7 +206,7 @@ public:
 	{
 		std::cout << __FUNCTION__ << " - sid:" << sid << ", message=" << std::string(reinterpret_cast<const char*>(data), len) << std::endl;
 
-		std::shared_ptr<net::IWriteBuffer> wbuffer(new net::WriteBufferImpl);
+		std::shared_ptr<net::IWriteBuffer> wbuffer = m_controller->CreateWriteBuffer(len);
 		wbuffer->Put(data, len);
 		wbuffer->Commit();
 
@@ -1,7 +1,10 @@
-#include <iostream>
 #include <vector>
+#include <algorithm>
 #include <boost/bind.hpp>
 #include "session.h"
+#include "buffer_pool.h"
+#include "socket_option.h"
+#include "cpu_topology.h"
 #include "network_impl.h"
 
 namespace net
@@ -9,7 +12,7 @@ namespace net
 NetworkImpl::NetworkImpl(const int32_t numberOfThreads)
 	: m_signalSet(m_ioContext, SIGINT, SIGTERM)
 	, m_numberOfThreads(numberOfThreads)
-	, m_sessionManager(new SessionManager)
+	, m_sessionManager(new SessionManager(std::max<int32_t>(numberOfThreads, 1)))
 	, m_service(nullptr)
 	, m_logging(nullptr)
 	, m_monitor(nullptr)
@@ -53,11 +56,16 @@ void NetworkImpl::AttachLogging(ILogging* logging)
 	}
 
 	m_logging = logging;
+	m_logger = Logger(logging);
 }
 
 void NetworkImpl::DetachLogging()
 {
 	m_logging = nullptr;
+	m_logger = Logger();
+
+	// 남은 로그를 전달한 뒤 반환한다.(이후 ILogging을 해제해도 된다.)
+	AsyncLogger::Instance().Flush();
 }
 
 void NetworkImpl::AttachMonitor(IMonitor* monitor)
@@ -104,6 +112,11 @@ void NetworkImpl::Stop()
 {
 	m_ioContext.stop();
 
+	for (auto& worker : m_workerGroup)
+	{
+		worker->Stop();
+	}
+
 	for (auto& t : m_threadGroup)
 	{
 		if (true == t.joinable())
@@ -111,6 +124,8 @@ void NetworkImpl::Stop()
 			t.join();
 		}
 	}
+
+	AsyncLogger::Instance().Flush();
 }
 
 bool NetworkImpl::IsState(const _sid_t& sid, const eState& state)
@@ -131,13 +146,21 @@ _sid_t NetworkImpl::Connect()
 		return 0;
 	}
 
+	CreateWorker();
+	CreateSocketOptions();
+	LoadSessionLimits();
+	CreateSessionPool();
+
 	_session_ptr_t session;
-	if (false == m_sessionManager->Create(m_ioContext, m_service, m_logging, m_monitor, session))
+	if (false == m_sessionManager->Create(NextWorker(), m_service, m_logger, m_monitor, session))
 	{
 		// TODO : 노티해줘야함.
 		return 0;
 	}
 
+	session->AttachSocketOptions(m_socketOptions.get());
+	ApplySessionLimits(session);
+
 	session->Resolve(m_configuration->GetAddress().first, m_configuration->GetAddress().second);
 
 	CreateWorkerThread();
@@ -152,41 +175,157 @@ bool NetworkImpl::Accept()
 		return false;
 	}
 
-	if (nullptr == m_acceptor) 
+	CreateWorker();
+	CreateSocketOptions();
+	LoadSessionLimits();
+	CreateSessionPool();
+
+	if (true == m_acceptShardGroup.empty()) 
 	{
-		m_acceptor.reset(new _acceptor_t(m_ioContext));
 		boost::asio::ip::tcp::resolver resolver(m_ioContext);
 		boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(m_configuration->GetAddress().first, m_configuration->GetAddress().second).begin();
-		m_acceptor->open(endpoint.protocol());
-		m_acceptor->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
-		m_acceptor->bind(endpoint);
-		m_acceptor->listen();
+
+		bool reusePort = m_configuration->ReusePort().value_or(false);
+#ifndef SO_REUSEPORT
+		reusePort = false;
+#endif
+		if (true == reusePort)
+		{
+			// 워커마다 리슨 소켓을 두고 커널이 새 연결을 분배하도록 한다.
+			for (auto& worker : m_workerGroup)
+			{
+				m_acceptShardGroup.emplace_back(new AcceptShard(worker->GetIoContext(), worker.get()));
+			}
+		}
+		else
+		{
+			m_acceptShardGroup.emplace_back(new AcceptShard(m_ioContext, nullptr));
+		}
+
+		for (auto& shard : m_acceptShardGroup)
+		{
+			Listen(*shard, endpoint, reusePort);
+		}
 
 		// 워커쓰레드 생성
 		CreateWorkerThread();
 	}
 
-	AcceptInner();
+	int32_t pendingAccepts = std::max<int32_t>(m_configuration->PendingAccepts().value_or(1), 1);
+	for (auto& shard : m_acceptShardGroup)
+	{
+		for (int32_t i = 0; i < pendingAccepts; ++i)
+		{
+			AcceptInner(shard.get());
+		}
+	}
 
 	return true;
 }
 
-bool NetworkImpl::Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len)
+eWriteResult NetworkImpl::Write(const _sid_t& sid, std::shared_ptr<uint8_t>& data, const std::size_t& len)
 {
 	_session_ptr_t session;
 	if (false == m_sessionManager->Lookup(sid, session))
 	{
-		return false;
+		return eWriteResult::NOT_FOUND;
+	}
+
+	if (false == session->Reserve(len))
+	{
+		return eWriteResult::WOULD_BLOCK;
 	}
 	
-	// TODO : Session을 이용해 Write 처리
-	//session->Write(data, len);
+	if (true == session->GetWorker().IsExclusive())
+	{
+		Submit(session, data, data.get(), len, LatencyStamp());
+		return eWriteResult::SUCCESS;
+	}
+
 	session->Post(data, len);
 
+	return eWriteResult::SUCCESS;
+}
+
+eWriteResult NetworkImpl::Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer)
+{
+	_session_ptr_t session;
+	if (false == m_sessionManager->Lookup(sid, session))
+	{
+		return eWriteResult::NOT_FOUND;
+	}
+
+	if (false == session->Reserve(buffer->GetLength()))
+	{
+		return eWriteResult::WOULD_BLOCK;
+	}
+
+	if (true == session->GetWorker().IsExclusive())
+	{
+		Submit(session, buffer, buffer->GetData(), buffer->GetLength(), LatencyStamp());
+		return eWriteResult::SUCCESS;
+	}
+
+	session->Post(buffer);
+
+	return eWriteResult::SUCCESS;
+}
+
+std::size_t NetworkImpl::Broadcast(std::span<const _sid_t> sids, std::shared_ptr<IWriteBuffer>& buffer)
+{
+	if (nullptr == buffer)
+	{
+		return 0;
+	}
+
+	const uint8_t* data = buffer->GetData();
+	const std::size_t length = buffer->GetLength();
+	const LatencyStamp stamp;
+
+	std::size_t count = 0;
+	for (auto& sid : sids)
+	{
+		_session_ptr_t session;
+		if (false == m_sessionManager->Lookup(sid, session))
+		{
+			continue;
+		}
+
+		if (false == session->Reserve(length))
+		{
+			continue;
+		}
+
+		++count;
+
+		// 단독 io_context를 사용하는 워커는 제출 큐에 쌓아 워커마다 한번만 깨운다.
+		if (true == session->GetWorker().IsExclusive())
+		{
+			Submit(session, buffer, data, length, stamp);
+			continue;
+		}
+
+		// strand를 사용하는 경우 세션마다 전달한다.(버퍼는 공유)
+		session->Post(buffer);
+	}
+
+	return count;
+}
+
+bool NetworkImpl::SetWriteWatermark(const _sid_t& sid, const WriteWatermark& watermark)
+{
+	_session_ptr_t session;
+	if (false == m_sessionManager->Lookup(sid, session))
+	{
+		return false;
+	}
+
+	session->SetWriteWatermark(watermark);
+
 	return true;
 }
 
-bool NetworkImpl::Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer)
+bool NetworkImpl::PauseRead(const _sid_t& sid)
 {
 	_session_ptr_t session;
 	if (false == m_sessionManager->Lookup(sid, session))
@@ -194,13 +333,263 @@ bool NetworkImpl::Write(const _sid_t& sid, std::shared_ptr<IWriteBuffer>& buffer
 		return false;
 	}
 
-	// TODO : Session을 이용해 Write 처리
-	//session->Write(data, len);
-	session->Post(buffer);
+	session->PauseRead();
+
+	return true;
+}
+
+bool NetworkImpl::ResumeRead(const _sid_t& sid)
+{
+	_session_ptr_t session;
+	if (false == m_sessionManager->Lookup(sid, session))
+	{
+		return false;
+	}
+
+	session->ResumeRead();
 
 	return true;
 }
 
+bool NetworkImpl::AckMessages(const _sid_t& sid, const uint32_t count)
+{
+	_session_ptr_t session;
+	if (false == m_sessionManager->Lookup(sid, session))
+	{
+		return false;
+	}
+
+	session->AckMessages(count);
+
+	return true;
+}
+
+bool NetworkImpl::GetRtt(const _sid_t& sid, RttEstimate& rtt)
+{
+	_session_ptr_t session;
+	if (false == m_sessionManager->Lookup(sid, session))
+	{
+		return false;
+	}
+
+	session->GetRtt(rtt);
+
+	return true;
+}
+
+void NetworkImpl::GetThroughput(_throughput_list_t& list)
+{
+	list.clear();
+	list.resize(m_workerGroup.size());
+
+	for (std::size_t i = 0; i < m_workerGroup.size(); ++i)
+	{
+		m_workerGroup[i]->GetThroughput(list[i]);
+	}
+}
+
+void NetworkImpl::Snapshot(MetricsSnapshot& snapshot)
+{
+	GetThroughput(snapshot.workers);
+
+	Throughput& total = snapshot.total;
+	total = Throughput();
+	for (auto& worker : snapshot.workers)
+	{
+		total.sessions += worker.sessions;
+		total.readCount += worker.readCount;
+		total.readBytes += worker.readBytes;
+		total.readFrames += worker.readFrames;
+		total.writeCount += worker.writeCount;
+		total.writeBytes += worker.writeBytes;
+		total.writeFrames += worker.writeFrames;
+		total.accepts += worker.accepts;
+		total.connects += worker.connects;
+		for (std::size_t i = 0; i < total.closes.size(); ++i)
+		{
+			total.closes[i] += worker.closes[i];
+		}
+		total.writeQueueDepth += worker.writeQueueDepth;
+		total.writeQueueBytes += worker.writeQueueBytes;
+		total.spinTime += worker.spinTime;
+		total.workTime += worker.workTime;
+		total.blockTime += worker.blockTime;
+		total.blocks += worker.blocks;
+	}
+}
+
+_write_buffer_ptr_t NetworkImpl::CreateWriteBuffer(const std::size_t& capacity)
+{
+	// shared_ptr 제어 블록도 풀에서 할당한다.
+	return std::allocate_shared<PooledWriteBuffer>(PoolAllocator<PooledWriteBuffer>(), capacity);
+}
+
+void NetworkImpl::GetBufferPoolStats(BufferPoolStats& stats)
+{
+	BufferPool::Instance().GetStats(stats);
+}
+
+void NetworkImpl::GetSessionPoolStats(SessionPoolStats& stats)
+{
+	stats = SessionPoolStats();
+
+	m_sessionManager->GetPoolStats(stats);
+}
+
+void NetworkImpl::GetPlacement(_placement_list_t& list)
+{
+	list.clear();
+
+	for (auto& worker : m_workerGroup)
+	{
+		list.emplace_back();
+		worker->GetPlacement(list.back());
+	}
+}
+
+void NetworkImpl::GetSocketOptionReport(const eSocketTarget& target, _socket_option_report_t& report)
+{
+	report.clear();
+
+	if (nullptr == m_socketOptions)
+	{
+		return;
+	}
+
+	m_socketOptions->GetReport(target, report);
+}
+
+void NetworkImpl::GetLatencyReport(_latency_report_t& report)
+{
+	report.clear();
+
+#ifdef _USE_LATENCY_HISTOGRAM
+	auto histograms = std::make_unique<_latency_histograms_t>();
+	for (auto& worker : m_workerGroup)
+	{
+		worker->MergeLatency(*histograms);
+	}
+
+	for (std::size_t i = 0; i < histograms->size(); ++i)
+	{
+		const LatencyHistogram& histogram = (*histograms)[i];
+
+		LatencyReport stage;
+		stage.stage = static_cast<eLatencyStage>(i);
+		stage.count = histogram.GetCount();
+		stage.p50 = histogram.GetPercentile(50.0);
+		stage.p99 = histogram.GetPercentile(99.0);
+		stage.p999 = histogram.GetPercentile(99.9);
+		stage.max = histogram.GetMax();
+		report.push_back(stage);
+	}
+#endif
+}
+
+void NetworkImpl::CreateSocketOptions()
+{
+	if (nullptr != m_socketOptions)
+	{
+		return;
+	}
+
+	m_socketOptions.reset(new SocketOptions(m_configuration, m_logger));
+}
+
+void NetworkImpl::LoadSessionLimits()
+{
+	if (true == m_writeWatermark.has_value())
+	{
+		return;
+	}
+
+	WriteWatermark watermark;
+
+	auto high = m_configuration->WriteHighWatermark();
+	if (true == high.has_value() && 0 < high.value())
+	{
+		watermark.high = static_cast<std::size_t>(high.value());
+		watermark.low = static_cast<std::size_t>(std::clamp(m_configuration->WriteLowWatermark().value_or(high.value() / 2), 0, high.value()));
+		watermark.timeout = static_cast<uint32_t>(std::max(m_configuration->WriteBlockTimeout().value_or(0), 0));
+	}
+
+	m_writeWatermark = watermark;
+	m_readBudget = static_cast<uint32_t>(std::max(m_configuration->ReadBudget().value_or(0), 0));
+	m_maxFrameLength = m_configuration->MaxFrameLength().value_or(Session::DEFAULT_MAX_FRAME_LENGTH);
+	if (0 >= m_maxFrameLength)
+	{
+		m_maxFrameLength = Session::DEFAULT_MAX_FRAME_LENGTH;
+	}
+
+	m_sessionTimeout.readIdle = static_cast<uint32_t>(std::max(m_configuration->ReadIdleTimeout().value_or(0), 0));
+	m_sessionTimeout.writeStall = static_cast<uint32_t>(std::max(m_configuration->WriteStallTimeout().value_or(0), 0));
+	m_sessionTimeout.heartbeat = static_cast<uint32_t>(std::max(m_configuration->HeartbeatInterval().value_or(0), 0));
+}
+
+void NetworkImpl::ApplySessionLimits(const _session_ptr_t& t_session)
+{
+	t_session->SetWriteWatermark(*m_writeWatermark);
+	t_session->SetReadBudget(m_readBudget);
+	t_session->SetMaxFrameLength(m_maxFrameLength);
+	t_session->SetTimeout(m_sessionTimeout);
+}
+
+void NetworkImpl::CreateSessionPool()
+{
+	// 처음 호출할 때(io 스레드를 시작하기 전) 한번만 만든다.
+	if (true == m_sessionPoolCreated)
+	{
+		return;
+	}
+
+	m_sessionPoolCreated = true;
+
+	std::size_t warmup = static_cast<std::size_t>(std::max(m_configuration->SessionPoolSize().value_or(0), 0));
+	std::size_t capacity = static_cast<std::size_t>(std::max(m_configuration->SessionPoolCapacity().value_or(0), 0));
+	capacity = std::max(capacity, warmup);
+
+	for (auto& worker : m_workerGroup)
+	{
+		m_sessionManager->CreatePool(*worker, capacity, warmup);
+	}
+}
+
+void NetworkImpl::CreateWorker()
+{
+	if (false == m_workerGroup.empty())
+	{
+		return;
+	}
+
+	eIoModel ioModel = eIoModel::SHARED;
+	if (true == HasConfiguration())
+	{
+		ioModel = m_configuration->IoModel().value_or(eIoModel::SHARED);
+	}
+
+	uint32_t numberOfWorkers = std::max<uint32_t>(m_numberOfThreads, 1);
+	for (uint32_t i = 0; i < numberOfWorkers; ++i)
+	{
+		if (eIoModel::PER_THREAD == ioModel)
+		{
+			_io_context_t* ioContext = &m_ioContext;
+			if (0 < i)
+			{
+				// 스레드 하나만 실행한다는 힌트를 준다.
+				m_ioContextGroup.emplace_back(new _io_context_t(1));
+				ioContext = m_ioContextGroup.back().get();
+			}
+
+			m_workerGroup.emplace_back(new IoWorker(i, *ioContext, true));
+			m_submitQueueGroup.emplace_back(new SubmitQueue(*m_workerGroup.back()));
+		}
+		else
+		{
+			m_workerGroup.emplace_back(new IoWorker(i, m_ioContext, false));
+		}
+	}
+}
+
 void NetworkImpl::CreateWorkerThread() 
 {
 	if (false == m_threadGroup.empty())
@@ -208,41 +597,124 @@ void NetworkImpl::CreateWorkerThread()
 		return;
 	}
 
-	for (uint32_t i = 0; i < m_numberOfThreads; ++i)
+	AssignCpuSets();
+
+	// 실행 방식(spin 후 블록)
+	int32_t spinTime = (true == HasConfiguration()) ? std::max<int32_t>(m_configuration->SpinTime().value_or(0), 0) : 0;
+	for (auto& worker : m_workerGroup)
 	{
-		m_threadGroup.emplace_back([this]() {
-			m_ioContext.run();
+		worker->SetSpinTime(std::chrono::microseconds(spinTime));
+	}
 
-			std::cout << "ioContext terminated" << std::endl;
+	for (auto& worker : m_workerGroup)
+	{
+		m_threadGroup.emplace_back([w = worker.get()]() {
+			w->Run();
 			});
 	}
 }
 
-void NetworkImpl::AcceptInner()
+void NetworkImpl::AssignCpuSets()
 {
+	if (false == HasConfiguration())
+	{
+		return;
+	}
+
+	std::vector<_cpu_list_t> cpuSets = m_configuration->WorkerCpuSets().value_or(std::vector<_cpu_list_t>());
+	if (true == cpuSets.empty())
+	{
+		cpuSets = CpuTopology::Instance().Place(m_configuration->CpuPlacement().value_or(eCpuPlacement::NONE), static_cast<uint32_t>(m_workerGroup.size()));
+	}
+
+	if (true == cpuSets.empty())
+	{
+		return;
+	}
+
+	for (auto& worker : m_workerGroup)
+	{
+		worker->SetCpuSet(cpuSets[worker->GetIndex() % cpuSets.size()]);
+	}
+}
+
+void NetworkImpl::Submit(const _session_ptr_t& t_session, std::shared_ptr<const void> t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp)
+{
+	IoWorker& worker = t_session->GetWorker();
+
+	// 세션의 io 스레드에서 요청한 경우 큐를 거치지 않고 바로 처리한다.
+	if (&worker == IoWorker::Current())
+	{
+		t_session->Deliver(std::move(t_holder), t_data, t_len, t_stamp);
+		return;
+	}
+
+	m_submitQueueGroup[worker.GetIndex()]->Submit(t_session, std::move(t_holder), t_data, t_len, t_stamp);
+}
+
+IoWorker& NetworkImpl::NextWorker()
+{
+	auto index = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workerGroup.size();
+	return *m_workerGroup[index];
+}
+
+void NetworkImpl::Listen(AcceptShard& t_shard, const boost::asio::ip::tcp::endpoint& t_endpoint, const bool t_reusePort)
+{
+	_socket_option_report_t report;
+
+	t_shard.acceptor.open(t_endpoint.protocol());
+	m_socketOptions->Apply(t_shard.acceptor, t_reusePort, report);
+	t_shard.acceptor.bind(t_endpoint);
+	m_socketOptions->Listen(t_shard.acceptor, std::move(report));
+}
+
+void NetworkImpl::AcceptInner(AcceptShard* t_shard)
+{
+	IoWorker& worker = (nullptr != t_shard->worker) ? *t_shard->worker : NextWorker();
+
 	_session_ptr_t session;
-	if (false == m_sessionManager->Create(m_ioContext, m_service, m_logging, m_monitor, session))
+	if (false == m_sessionManager->Create(worker, m_service, m_logger, m_monitor, session))
 	{
 		// TODO : 노티해줘야함.
 		return;
 	}
 
-	m_acceptor->async_accept(session->getSocket(),
-		boost::bind(&NetworkImpl::HandleAccept, this, session, boost::asio::placeholders::error)
+	ApplySessionLimits(session);
+
+	t_shard->acceptor.async_accept(session->getSocket(),
+		boost::asio::make_custom_alloc_handler(session->GetAcceptMemory(),
+			boost::bind(&NetworkImpl::HandleAccept, this, t_shard, session, boost::asio::placeholders::error)
+		)
 	);
 }
 
-void NetworkImpl::HandleAccept(_session_ptr_t session, const boost::system::error_code& t_errorCode)
+void NetworkImpl::HandleAccept(AcceptShard* t_shard, _session_ptr_t session, const boost::system::error_code& t_errorCode)
 {
 	if (!t_errorCode)
 	{
+		m_socketOptions->Apply(session->getSocket(), eSocketTarget::ACCEPTED);
+
+		if (auto counter = ThroughputCounter::Current())
+		{
+			ThroughputCounter::Add(counter->accepts, 1);
+		}
+
 		session->Start();
 	}
 	else
 	{
-		std::cout << "error : " << t_errorCode.message() << std::endl;
+		// 연결되지 않은 세션은 테이블에서 빼서 해제한다.(풀을 사용하면 풀로 돌아간다.)
+		m_sessionManager->Remove(session->GetSID());
+
+		// 리슨 소켓이 닫힌 경우 다시 걸지 않는다.
+		if (boost::asio::error::operation_aborted == t_errorCode)
+		{
+			return;
+		}
+
+		m_logger.Write<eLogLevel::WARN>(__FUNCTION__, __LINE__, t_errorCode);
 	}
 
-	AcceptInner();
+	AcceptInner(t_shard);
 }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
-#include <iostream>
+#include <cstring>
+#include <limits>
 #include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
 #include "session.h"
@@ -6,49 +7,141 @@
 namespace net
 {
 #pragma region R_SESSION
-Session::Session(const _sid_t& t_sid, _io_context_t& t_ioContext, IListener* t_service, ILogging* t_logging, IMonitor* t_monitor, _destroy_callback_t&& t_destroyCallback)
+Session::Session(const _sid_t& t_sid, IoWorker& t_worker, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor, _destroy_callback_t&& t_destroyCallback)
 	: m_sid(t_sid)
-	, m_ioContext(t_ioContext)
-	, m_strand(boost::asio::make_strand(t_ioContext))
-	, m_socket(m_strand)
+	, m_worker(t_worker)
+	, m_socket(t_worker.GetExecutor())
 	, m_service(t_service)
-	, m_logging(t_logging)
+	, m_logger(t_logger)
 	, m_monitor(t_monitor)
 	, m_destroyCallback(std::forward<_destroy_callback_t>(t_destroyCallback))
 {
+	if (false == t_worker.IsExclusive())
+	{
+		m_strand.emplace(boost::asio::make_strand(t_worker.GetExecutor()));
+	}
+}
+
+Session::~Session()
+{
+	TimerWheel::Cancel(m_timer);
+}
+
+void Session::Reset()
+{
+	TimerWheel::Cancel(m_timer);
+
+	// Close 없이 해제된 경우(accept 실패 등)
+	boost::system::error_code ignoredErrorCode;
+	m_socket.close(ignoredErrorCode);
+
+	m_state = eState::NONE;
+	m_sid = 0;
+	m_socketOptions = nullptr;
+
+	m_messageBuffer.Clear();
+	m_messageBuffer.Shrink(MIN_READ_SIZE);
+	m_readSize = MIN_READ_SIZE;
+	m_smallReadCount = 0;
+	m_maxFrameLength = DEFAULT_MAX_FRAME_LENGTH;
+
+	// 큰 프레임을 이어 붙였던 버퍼는 돌려준다.
+	if (static_cast<std::size_t>(MAX_READ_SIZE) < m_frameBuffer.capacity())
+	{
+		std::vector<uint8_t>().swap(m_frameBuffer);
+	}
+	m_frameBuffer.clear();
+
+	m_reading = false;
+	m_readPaused = false;
+	m_readBudget.store(0, std::memory_order_relaxed);
+	m_unprocessed.store(0, std::memory_order_relaxed);
+
+	m_writeState = eWriteState::IDEL;
+	m_writeQueue.Clear();
+
+	m_pendingBytes.store(0, std::memory_order_relaxed);
+	m_highWatermark.store(0, std::memory_order_relaxed);
+	m_lowWatermark.store(0, std::memory_order_relaxed);
+	m_blockTimeout.store(0, std::memory_order_relaxed);
+	m_writeBlocked.store(false, std::memory_order_relaxed);
+	m_blockTimerActive = false;
+	m_blockSince = 0;
+
+	m_timerExpire = 0;
+	m_readIdleTicks = 0;
+	m_writeStallTicks = 0;
+	m_heartbeatTicks = 0;
+	m_lastRead = 0;
+	m_lastWrite = 0;
+	m_lastPing = 0;
+
+	m_rttLatest.store(0, std::memory_order_relaxed);
+	m_rttSmoothed.store(0, std::memory_order_relaxed);
+	m_rttVariance.store(0, std::memory_order_relaxed);
+	m_rttMin.store(0, std::memory_order_relaxed);
+	m_rttSamples.store(0, std::memory_order_relaxed);
+}
+
+void Session::Reuse(const _sid_t& t_sid, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor)
+{
+	m_sid = t_sid;
+	m_service = t_service;
+	m_logger = t_logger;
+	m_monitor = t_monitor;
 }
 
 void Session::Resolve(const std::string& t_address, const std::string& t_port)
 {
 	if (nullptr == m_resolver)
 	{
-		m_resolver.reset(new _resolver_t(m_ioContext));
+		m_resolver.reset(new _resolver_t(m_worker.GetIoContext()));
 	}
 
 	// 연결 중
 	SetState(eState::CONNECTING);
 
 	boost::asio::ip::tcp::resolver::query query(t_address, t_port);
-	m_resolver->async_resolve(query,
-		boost::bind(&Session::HandleResolve, shared_from_this(),
-			boost::asio::placeholders::error,
-			boost::asio::placeholders::results));
+	StartOperation([this, &query](auto&& t_handler) {
+			m_resolver->async_resolve(query, std::move(t_handler));
+		},
+		boost::asio::make_custom_alloc_handler(m_connectMemory,
+			boost::bind(&Session::HandleResolve, shared_from_this(),
+				boost::asio::placeholders::error,
+				boost::asio::placeholders::results)
+		)
+	);
 }
 
 void Session::Start()
 {
 	SetState(eState::CONNECTED);
 
-	Post([this] {
-			Read();
+	m_worker.GetCounter().sessions.fetch_add(1, std::memory_order_relaxed);
 
-			OnConnected();
+	// 핸들러가 세션을 참조해야 실행 전에 세션이 풀로 돌아가 다른 연결에 사용되지 않는다.
+	Post([self = shared_from_this()] {
+			self->m_lastRead = self->m_lastWrite = self->m_lastPing = self->GetTick();
+			self->ScheduleTimer();
+
+			if (true == self->CanRead())
+			{
+				self->Read();
+			}
+
+			self->OnConnected();
 		}
 	);
 }
 
 void Session::Close(boost::system::error_code t_errorCode)
 {
+	// 읽기/쓰기/타이머 완료에서 중복 호출될 수 있다.
+	if (true == IsState(eState::CLOSED))
+	{
+		return;
+	}
+
 	if (!t_errorCode)
 	{
 		boost::system::error_code ignoredErrorCode;
@@ -61,6 +154,25 @@ void Session::Close(boost::system::error_code t_errorCode)
 		m_socket.close(closeErrorCode);
 	}
 
+	StopBlockTimer();
+
+	TimerWheel::Cancel(m_timer);
+	m_timerExpire = 0;
+
+	if (true == IsState(eState::CONNECTED))
+	{
+		m_worker.GetCounter().sessions.fetch_sub(1, std::memory_order_relaxed);
+
+		if (auto counter = ThroughputCounter::Current())
+		{
+			ThroughputCounter::Add(counter->closes[static_cast<std::size_t>(ThroughputCounter::GetCloseReason(t_errorCode))], 1);
+
+			// 보내지 못한 메시지는 대기 수에서 뺀다.(이후 완료되는 쓰기는 집계하지 않는다.)
+			ThroughputCounter::Sub(counter->writeQueueDepth, m_writeQueue.GetCount());
+			ThroughputCounter::Sub(counter->writeQueueBytes, m_writeQueue.GetLength());
+		}
+	}
+
 	OnClose(t_errorCode);
 
 	m_destroyCallback(m_sid);
@@ -73,57 +185,408 @@ void Session::Close(boost::system::error_code t_errorCode)
 
 void Session::PostClose(boost::system::error_code t_errorCode)
 {
-	Post([this, t_errorCode]() {
-		Close(t_errorCode);
+	Post([self = shared_from_this(), t_errorCode]() {
+		self->Close(t_errorCode);
 		}
 	);
 }
 
 void Session::Post(std::shared_ptr<uint8_t> t_data, const std::size_t& t_len)
 {
-	Post([this, t_data, t_len]() {
+	// 세션의 strand 안(OnMessage 등)에서 요청한 경우 다시 예약하지 않고 바로 처리한다.
+	if (true == IsInStrand())
+	{
+		Deliver(t_data, t_data.get(), t_len, LatencyStamp());
+		return;
+	}
+
+	bool posted = Post([self = shared_from_this(), t_data, t_len, stamp = LatencyStamp()]() {
 		const uint8_t* pointer = reinterpret_cast<const uint8_t*>(t_data.get());
-		Write(pointer, t_len);
+		self->Deliver(t_data, pointer, t_len, stamp);
 		}
 	);
+
+	if (false == posted)
+	{
+		Release(t_len);
+	}
 }
 
 void Session::Post(std::shared_ptr<IWriteBuffer>& t_buffer)
 {
-	Post([this, t_buffer]() {
-		Write(t_buffer->GetData(), t_buffer->GetLength());
+	if (true == IsInStrand())
+	{
+		Deliver(t_buffer, t_buffer->GetData(), t_buffer->GetLength(), LatencyStamp());
+		return;
+	}
+
+	bool posted = Post([self = shared_from_this(), t_buffer, stamp = LatencyStamp()]() {
+		self->Deliver(t_buffer, t_buffer->GetData(), t_buffer->GetLength(), stamp);
+		}
+	);
+
+	if (false == posted)
+	{
+		Release(t_buffer->GetLength());
+	}
+}
+
+bool Session::Reserve(const std::size_t& t_len)
+{
+	std::size_t high = m_highWatermark.load(std::memory_order_relaxed);
+	if (0 < high && high <= m_pendingBytes.load(std::memory_order_acquire))
+	{
+		// 처음 막힌 경우 io 스레드에서 다시 확인한다.(확인 직전에 줄어들었다면 알림을 놓치지 않도록)
+		if (false == m_writeBlocked.exchange(true, std::memory_order_acq_rel))
+		{
+			PostHandler([self = shared_from_this()]() {
+				self->CheckWritable();
+				}
+			);
+		}
+		return false;
+	}
+
+	m_pendingBytes.fetch_add(t_len, std::memory_order_acq_rel);
+	return true;
+}
+
+void Session::SetWriteWatermark(const WriteWatermark& t_watermark)
+{
+	m_highWatermark.store(t_watermark.high, std::memory_order_relaxed);
+	m_lowWatermark.store(std::min(t_watermark.low, t_watermark.high), std::memory_order_relaxed);
+	m_blockTimeout.store(t_watermark.timeout, std::memory_order_relaxed);
+}
+
+void Session::SetTimeout(const SessionTimeout& t_timeout)
+{
+	m_readIdleTicks = TimerWheel::ToTicks(t_timeout.readIdle);
+	m_writeStallTicks = TimerWheel::ToTicks(t_timeout.writeStall);
+	m_heartbeatTicks = TimerWheel::ToTicks(t_timeout.heartbeat);
+}
+
+void Session::GetRtt(RttEstimate& t_rtt) const
+{
+	t_rtt.samples = m_rttSamples.load(std::memory_order_acquire);
+	t_rtt.latest = m_rttLatest.load(std::memory_order_relaxed);
+	t_rtt.smoothed = m_rttSmoothed.load(std::memory_order_relaxed);
+	t_rtt.variance = m_rttVariance.load(std::memory_order_relaxed);
+	t_rtt.min = m_rttMin.load(std::memory_order_relaxed);
+}
+
+void Session::CheckWritable()
+{
+	if (false == m_writeBlocked.load(std::memory_order_acquire) || false == IsState(eState::CONNECTED))
+	{
+		return;
+	}
+
+	if (m_lowWatermark.load(std::memory_order_relaxed) < m_pendingBytes.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	if (true == m_writeBlocked.exchange(false, std::memory_order_acq_rel))
+	{
+		OnWritable();
+	}
+}
+
+void Session::StartBlockTimer()
+{
+	uint32_t timeout = m_blockTimeout.load(std::memory_order_relaxed);
+	if (0 == timeout || true == m_blockTimerActive)
+	{
+		return;
+	}
+
+	m_blockTimerActive = true;
+	m_blockSince = GetTick();
+
+	ArmTimer(m_blockSince + TimerWheel::ToTicks(timeout));
+}
+
+void Session::StopBlockTimer()
+{
+	// 걸어둔 타이머는 만료될 때 남은 시간을 다시 계산한다.
+	m_blockTimerActive = false;
+}
+
+void Session::OnTimerExpire()
+{
+	// 휠의 lock 안이므로 세션의 executor에서 처리한다.
+	// 마지막 참조를 여기서 놓으면 소멸자에서 같은 lock을 잡게 되므로 핸들러로 옮긴다.
+	boost::shared_ptr<Session> self = weak_from_this().lock();
+	if (nullptr == self)
+	{
+		return;
+	}
+
+	PostHandler([self = std::move(self)]() {
+		self->HandleTimer();
 		}
 	);
 }
 
-void Session::Write(const uint8_t* t_data, const std::size_t& t_len)
+void Session::HandleTimer()
 {
-	m_writeQueue.Put(t_data, t_len);
+	m_timerExpire = 0;
+
+	if (false == IsState(eState::CONNECTED))
+	{
+		return;
+	}
+
+	uint64_t tick = GetTick();
+
+	// 수신을 멈춘 동안(PauseRead, 처리 한도)은 유휴 시간을 재지 않는다.
+	if (0 < m_readIdleTicks && true == CanRead() && m_lastRead + m_readIdleTicks <= tick)
+	{
+		Log<eLogLevel::WARN>(__FUNCTION__, __LINE__, "read idle timeout.");
+		Close(boost::asio::error::timed_out);
+		return;
+	}
+
+	if (0 < m_writeStallTicks && true == IsWriteState(eWriteState::WRITING) && m_lastWrite + m_writeStallTicks <= tick)
+	{
+		Log<eLogLevel::WARN>(__FUNCTION__, __LINE__, "write stalled.");
+		Close(boost::asio::error::timed_out);
+		return;
+	}
+
+	if (true == m_blockTimerActive && m_blockSince + TimerWheel::ToTicks(m_blockTimeout.load(std::memory_order_relaxed)) <= tick)
+	{
+		m_blockTimerActive = false;
+
+		// 그 사이 low watermark 이하로 줄었으면 유지한다.
+		if (m_lowWatermark.load(std::memory_order_relaxed) < m_writeQueue.GetLength())
+		{
+			Log<eLogLevel::WARN>(__FUNCTION__, __LINE__, "write queue stayed above the high watermark.");
+			Close(boost::asio::error::timed_out);
+			return;
+		}
+	}
+
+	if (0 < m_heartbeatTicks && m_lastPing + m_heartbeatTicks <= tick)
+	{
+		m_lastPing = tick;
+
+		uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		SendControl(eControlFrame::PING, now);
+
+		if (false == IsState(eState::CONNECTED))
+		{
+			return;
+		}
+	}
+
+	ScheduleTimer();
+}
+
+void Session::ScheduleTimer()
+{
+	uint64_t expire = std::numeric_limits<uint64_t>::max();
+
+	if (0 < m_readIdleTicks && true == CanRead())
+	{
+		expire = std::min(expire, m_lastRead + m_readIdleTicks);
+	}
+
+	if (0 < m_heartbeatTicks)
+	{
+		expire = std::min(expire, m_lastPing + m_heartbeatTicks);
+	}
+
+	if (0 < m_writeStallTicks && true == IsWriteState(eWriteState::WRITING))
+	{
+		expire = std::min(expire, m_lastWrite + m_writeStallTicks);
+	}
+
+	if (true == m_blockTimerActive)
+	{
+		expire = std::min(expire, m_blockSince + TimerWheel::ToTicks(m_blockTimeout.load(std::memory_order_relaxed)));
+	}
+
+	if (std::numeric_limits<uint64_t>::max() != expire)
+	{
+		ArmTimer(expire);
+	}
+}
+
+void Session::ArmTimer(const uint64_t t_expire)
+{
+	// 더 이른 만료가 걸려 있으면 그때 다시 계산하므로 휠을 건드리지 않는다.
+	if ((0 != m_timerExpire && m_timerExpire <= t_expire) || false == IsState(eState::CONNECTED))
+	{
+		return;
+	}
+
+	m_timerExpire = t_expire;
+
+	m_worker.StartTimerWheel();
+	m_worker.GetTimerWheel().Schedule(m_timer, t_expire);
+}
+
+void Session::SendControl(const eControlFrame t_type, const uint64_t t_value)
+{
+	auto frame = std::allocate_shared<_control_frame_t>(PoolAllocator<_control_frame_t>());
+
+	int32_t type = static_cast<int32_t>(t_type);
+	memcpy(frame->data(), &type, sizeof(type));
+	memcpy(frame->data() + sizeof(type), &t_value, sizeof(t_value));
+
+	// 앱의 쓰기와 같이 대기 크기에 넣는다.(완료되면 HandleWrite에서 뺀다.)
+	m_pendingBytes.fetch_add(frame->size(), std::memory_order_acq_rel);
+
+	const uint8_t* data = frame->data();
+	Write(std::move(frame), data, sizeof(_control_frame_t), LatencyStamp());
+}
+
+void Session::HandleControl(const eControlFrame t_type, const uint64_t t_value)
+{
+	switch (t_type)
+	{
+	case eControlFrame::PING:
+		SendControl(eControlFrame::PONG, t_value);
+		break;
+
+	case eControlFrame::PONG:
+	{
+		uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		if (t_value <= now)
+		{
+			UpdateRtt(now - t_value);
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void Session::UpdateRtt(const uint64_t t_rtt)
+{
+	// RFC 6298 (alpha = 1/8, beta = 1/4)
+	uint32_t samples = m_rttSamples.load(std::memory_order_relaxed);
+
+	uint64_t smoothed = t_rtt;
+	uint64_t variance = t_rtt / 2;
+	uint64_t min = t_rtt;
+	if (0 < samples)
+	{
+		smoothed = m_rttSmoothed.load(std::memory_order_relaxed);
+		variance = m_rttVariance.load(std::memory_order_relaxed);
+		min = std::min(m_rttMin.load(std::memory_order_relaxed), t_rtt);
+
+		uint64_t diff = (smoothed > t_rtt) ? smoothed - t_rtt : t_rtt - smoothed;
+		variance = (variance * 3 + diff) / 4;
+		smoothed = (smoothed * 7 + t_rtt) / 8;
+	}
+
+	m_rttLatest.store(t_rtt, std::memory_order_relaxed);
+	m_rttSmoothed.store(smoothed, std::memory_order_relaxed);
+	m_rttVariance.store(variance, std::memory_order_relaxed);
+	m_rttMin.store(min, std::memory_order_relaxed);
+	m_rttSamples.store(samples + 1, std::memory_order_release);
+}
+
+void Session::Deliver(WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp)
+{
+	// 요청 이후 종료된 세션
+	if (false == IsState(eState::CONNECTED))
+	{
+		Release(t_len);
+		return;
+	}
+
+	Write(std::move(t_holder), t_data, t_len, t_stamp);
+}
+
+void Session::Write(WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp)
+{
+	// 복사 없이 버퍼 참조만 대기 큐에 넣는다.
+	m_writeQueue.Put(std::move(t_holder), t_data, t_len, t_stamp);
+
+	if (auto counter = ThroughputCounter::Current())
+	{
+		ThroughputCounter::Add(counter->writeFrames, 1);
+		ThroughputCounter::Add(counter->writeQueueDepth, 1);
+		ThroughputCounter::Add(counter->writeQueueBytes, t_len);
+	}
+
+	if (nullptr != m_monitor)
+	{
+		m_monitor->OnSend(m_sid, t_len);
+	}
+
+	std::size_t high = m_highWatermark.load(std::memory_order_relaxed);
+	if (0 < high && high <= m_writeQueue.GetLength())
+	{
+		StartBlockTimer();
+	}
 	
 	// 아무것도 하지 않는 경우 쓰기 처리를 한다.
 	if (true == IsWriteState(eWriteState::IDEL))
 	{
-		m_writeQueue.Switch();
+		Send();
+	}
+}
 
-		WriteQueue::_streambuf_t::const_buffers_type buffer = m_writeQueue.GetWritingBuffer().data();
-		boost::asio::async_write(
-			m_socket, buffer,
-			boost::asio::make_custom_alloc_handler(m_handlerMemory,
-				boost::bind(&Session::HandleWrite, shared_from_this(), 
-					boost::asio::placeholders::error,
-					boost::asio::placeholders::bytes_transferred)
-			)
-		);
+void Session::Send()
+{
+	if (true == m_writeQueue.IsEmpty())
+	{
+		return;
+	}
 
-		// 쓰기 상태로 변경한다.
-		SetWriteState(eWriteState::WRITING);
+	// 쓰기 상태로 변경한다.
+	SetWriteState(eWriteState::WRITING);
+
+	m_lastWrite = GetTick();
+	if (0 < m_writeStallTicks)
+	{
+		ArmTimer(m_lastWrite + m_writeStallTicks);
 	}
+
+	WriteQueue::_gather_buffers_t buffers = m_writeQueue.Gather();
+
+#ifdef _USE_LATENCY_HISTOGRAM
+	m_sendStamp = LatencyStamp();
+	m_writeQueue.ForEach(buffers.size(), [this](const WriteQueue::Item& t_item) {
+		IoWorker::RecordLatency(eLatencyStage::WRITE_QUEUE, t_item.stamp, m_sendStamp);
+		}
+	);
+#endif
+
+	StartOperation([this, &buffers](auto&& t_handler) {
+			boost::asio::async_write(m_socket, buffers, std::move(t_handler));
+		},
+		boost::asio::make_custom_alloc_handler(m_writeMemory,
+			boost::bind(&Session::HandleWrite, shared_from_this(), 
+				boost::asio::placeholders::error,
+				boost::asio::placeholders::bytes_transferred)
+		)
+	);
 }
 
 void Session::Read()
 {
-	m_socket.async_read_some(boost::asio::buffer(m_readBuffer),
-		boost::asio::make_custom_alloc_handler(m_handlerMemory,
+	// 수신 버퍼의 빈 공간(끝에서 나뉘면 두 구간)에 바로 받는다.
+	_read_regions_t regions;
+	m_messageBuffer.Prepare(m_readSize, regions);
+
+	std::array<boost::asio::mutable_buffer, 2> buffers = {
+		boost::asio::buffer(regions[0].first, regions[0].second),
+		boost::asio::buffer(regions[1].first, regions[1].second),
+	};
+
+	m_reading = true;
+
+	StartOperation([this, &buffers](auto&& t_handler) {
+			m_socket.async_read_some(buffers, std::move(t_handler));
+		},
+		boost::asio::make_custom_alloc_handler(m_readMemory,
 			boost::bind(&Session::HandleRead, shared_from_this(),
 				boost::asio::placeholders::error,
 				boost::asio::placeholders::bytes_transferred)
@@ -133,89 +596,303 @@ void Session::Read()
 
 void Session::HandleRead(const boost::system::error_code& t_errorCode, std::size_t t_bytesTransferred)
 {
+	m_reading = false;
+
 	if (t_errorCode)
 	{
 		Close(t_errorCode);
 		return;
 	}
 
-	m_messageBuffer.Write(m_readBuffer.data(), static_cast<int32_t>(t_bytesTransferred));
-	
-	uint8_t header[4] = { 0, };
-	auto headerSize = static_cast<int32_t>(sizeof(header));
+	LatencyStamp readStamp;
 
-	m_messageBuffer.Read(header, headerSize);
-	auto dataLength = *((int32_t*)header);
+	// 타이머는 다시 걸지 않고 시각만 기록한다.(만료되면 HandleTimer에서 확인한다.)
+	m_lastRead = GetTick();
 
-	Log(eLogLevel::DEBUG, __FUNCTION__, __LINE__, "");
+	ThroughputCounter* counter = ThroughputCounter::Current();
+	if (nullptr != counter)
+	{
+		ThroughputCounter::Add(counter->readCount, 1);
+		ThroughputCounter::Add(counter->readBytes, t_bytesTransferred);
+	}
 
-	while ((headerSize + dataLength) <= m_messageBuffer.GetLength())
+	if (nullptr != m_monitor)
 	{
-		// 2. 완료된 패킷을 콜백에 올려준다.
-		std::shared_ptr<uint8_t> message(
-			new uint8_t[dataLength], 
-			[](uint8_t* pointer) {
-				delete[] pointer;
+		m_monitor->OnReceive(m_sid, t_bytesTransferred);
+	}
+
+	m_messageBuffer.Commit(static_cast<int32_t>(t_bytesTransferred));
+
+	if (false == Dispatch(readStamp))
+	{
+		return;
+	}
+
+	AdjustReadSize(t_bytesTransferred);
+
+	// 수신을 멈췄으면 다시 걸지 않는다.(TCP 수신 윈도우가 차서 상대방의 전송이 늦춰진다.)
+	if (true == CanRead())
+	{
+		Read();
+	}
+}
+
+bool Session::Dispatch(const LatencyStamp& t_readStamp)
+{
+	ThroughputCounter* counter = ThroughputCounter::Current();
+
+	constexpr int32_t headerSize = static_cast<int32_t>(sizeof(int32_t));
+	while (headerSize <= m_messageBuffer.GetLength())
+	{
+		// 멈춘 동안 남은 프레임은 ContinueRead에서 전달한다.
+		if (false == CanRead())
+		{
+			break;
+		}
+
+		int32_t dataLength = 0;
+		m_messageBuffer.Read(reinterpret_cast<uint8_t*>(&dataLength), headerSize);
+
+		// 한도를 넘는 길이는 기다리지 않고 끊는다.(수신 버퍼가 끝없이 늘어나지 않도록 한다.)
+		if (m_maxFrameLength < dataLength)
+		{
+			Close(boost::asio::error::message_size);
+			return false;
+		}
+
+		if (0 > dataLength)
+		{
+			if (static_cast<int32_t>(eControlFrame::PING) != dataLength && static_cast<int32_t>(eControlFrame::PONG) != dataLength)
+			{
+				Close(boost::asio::error::invalid_argument);
+				return false;
 			}
-		);
 
-		// Header Size 
-		m_messageBuffer.Consume(headerSize);
-		m_messageBuffer.ReadAndConsume(message.get(), dataLength);
-		
-		OnMessage(message.get(), dataLength);
+			// 제어 프레임은 서비스에 전달하지 않는다.
+			constexpr int32_t valueSize = static_cast<int32_t>(sizeof(uint64_t));
+			if ((headerSize + valueSize) > m_messageBuffer.GetLength())
+			{
+				break;
+			}
+
+			uint64_t value = 0;
+			m_messageBuffer.Consume(headerSize);
+			m_messageBuffer.ReadAndConsume(reinterpret_cast<uint8_t*>(&value), valueSize);
+
+			HandleControl(static_cast<eControlFrame>(dataLength), value);
+
+			if (false == IsState(eState::CONNECTED))
+			{
+				return false;
+			}
+			continue;
+		}
 
-		if (headerSize >= m_messageBuffer.GetLength())
-		{ 
+		// 헤더를 더한 크기는 std::size_t로 계산한다.(한도 안이므로 int32_t로 돌려도 넘치지 않는다.)
+		const std::size_t frameSize = static_cast<std::size_t>(headerSize) + static_cast<std::size_t>(dataLength);
+		if (frameSize > static_cast<std::size_t>(m_messageBuffer.GetLength()))
+		{
 			break;
 		}
 
-		memset(header, 0x00, headerSize);
-		m_messageBuffer.Read(header, headerSize);
-		dataLength = *((int32_t*)header);
+		if (nullptr != counter)
+		{
+			ThroughputCounter::Add(counter->readFrames, 1);
+		}
+
+		// 2. 완료된 패킷을 콜백에 올려준다.
+		// 수신 버퍼에 연속으로 있으면 복사 없이 전달하고, 끝에서 나뉘어 있을 때만 프레임 버퍼로 복사한다.
+		const uint8_t* frame = m_messageBuffer.Peek(static_cast<int32_t>(frameSize));
+		IoWorker::RecordLatency(eLatencyStage::READ_DISPATCH, t_readStamp);
+
+		// 콜백 안에서 AckMessages를 호출할 수 있으므로 전달 전에 센다.
+		if (0 < m_readBudget.load(std::memory_order_relaxed))
+		{
+			m_unprocessed.fetch_add(1, std::memory_order_acq_rel);
+		}
+
+		if (nullptr != frame)
+		{
+			OnMessage(frame + headerSize, dataLength);
+			m_messageBuffer.Consume(static_cast<int32_t>(frameSize));
+		}
+		else
+		{
+			m_frameBuffer.resize(dataLength);
+
+			m_messageBuffer.Consume(headerSize);
+			m_messageBuffer.ReadAndConsume(m_frameBuffer.data(), dataLength);
+
+			OnMessage(m_frameBuffer.data(), dataLength);
+		}
+
+		// 콜백에서 세션이 종료되었을 경우
+		if (false == IsState(eState::CONNECTED))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Session::PauseRead()
+{
+	PostHandler([self = shared_from_this()]() {
+		self->m_readPaused = true;
+		}
+	);
+}
+
+void Session::ResumeRead()
+{
+	PostHandler([self = shared_from_this()]() {
+		self->m_readPaused = false;
+		self->ContinueRead();
+		}
+	);
+}
+
+void Session::AckMessages(const uint32_t& t_count)
+{
+	uint32_t budget = m_readBudget.load(std::memory_order_relaxed);
+	if (0 == budget)
+	{
+		return;
+	}
+
+	// 전달한 수보다 많이 알려도 0 아래로 내려가지 않도록 한다.
+	uint32_t before = m_unprocessed.load(std::memory_order_relaxed);
+	uint32_t after = 0;
+	do
+	{
+		after = before - std::min(before, t_count);
+	} while (false == m_unprocessed.compare_exchange_weak(before, after, std::memory_order_acq_rel));
+
+	// 한도에 걸려 멈췄던 수신을 다시 시작한다.
+	if (budget <= before && budget > after)
+	{
+		PostHandler([self = shared_from_this()]() {
+			self->ContinueRead();
+			}
+		);
+	}
+}
+
+void Session::ContinueRead()
+{
+	if (false == IsState(eState::CONNECTED))
+	{
+		return;
+	}
+
+	// 멈춘 동안은 유휴 시간을 재지 않았으므로 다시 시작한 시각부터 잰다.
+	if (true == CanRead())
+	{
+		m_lastRead = GetTick();
+		ScheduleTimer();
+	}
+
+	// 수신 중이면 완료 후 HandleRead에서 이어서 처리한다.
+	if (true == m_reading)
+	{
+		return;
+	}
+
+	if (false == Dispatch(LatencyStamp()))
+	{
+		return;
+	}
+
+	if (true == CanRead())
+	{
+		Read();
+	}
+}
+
+void Session::AdjustReadSize(const std::size_t& t_bytesTransferred)
+{
+	// 요청한 만큼 가득 받았다면 대량 전송 중이다.
+	if (static_cast<std::size_t>(m_readSize) <= t_bytesTransferred)
+	{
+		m_readSize = std::min(m_readSize << 1, MAX_READ_SIZE);
+		m_smallReadCount = 0;
+		return;
+	}
+
+	if (static_cast<std::size_t>(m_readSize >> 2) <= t_bytesTransferred)
+	{
+		m_smallReadCount = 0;
+		return;
 	}
 
-	Read();
+	// 작은 수신이 이어지면 줄이고, 비어 있는 수신 버퍼도 돌려준다.
+	if (SHRINK_READ_COUNT > ++m_smallReadCount)
+	{
+		return;
+	}
+
+	m_smallReadCount = 0;
+	m_readSize = std::max(m_readSize >> 1, MIN_READ_SIZE);
+	m_messageBuffer.Shrink(m_readSize);
 }
 
 void Session::HandleWrite(const boost::system::error_code& t_errorCode, std::size_t t_bytesTransferred)
 {
+#ifdef _USE_LATENCY_HISTOGRAM
+	if (!t_errorCode)
+	{
+		LatencyStamp sentStamp;
+		IoWorker::RecordLatency(eLatencyStage::WRITE_SEND, m_sendStamp, sentStamp);
+		m_writeQueue.ForEachCompleted(t_bytesTransferred, [&sentStamp](const WriteQueue::Item& t_item) {
+			IoWorker::RecordLatency(eLatencyStage::WRITE_TOTAL, t_item.stamp, sentStamp);
+			}
+		);
+	}
+#endif
+
+	std::size_t count = m_writeQueue.GetCount();
 	m_writeQueue.Consume(t_bytesTransferred);
+	Release(t_bytesTransferred);
+
+	// 종료된 세션은 Close에서 남은 대기 수를 정리했다.
+	ThroughputCounter* counter = ThroughputCounter::Current();
+	if (nullptr != counter && true == IsState(eState::CONNECTED))
+	{
+		ThroughputCounter::Sub(counter->writeQueueDepth, count - m_writeQueue.GetCount());
+		ThroughputCounter::Sub(counter->writeQueueBytes, t_bytesTransferred);
+	}
 
 	if (t_errorCode)
 	{
-		std::cout << __FUNCTION__ << " - failed. message=" << t_errorCode.message() << std::endl;
+		Log<eLogLevel::DEBUG>(__FUNCTION__, __LINE__, t_errorCode);
 		Close(t_errorCode);
 		return;
 	}
 
-	SetWriteState(eWriteState::IDEL);
-	
-	auto transmissibleBufferType = m_writeQueue.GetTransmissibleBufferType();
-	if (WriteQueue::eBufferType::NONE == transmissibleBufferType)
+	if (nullptr != counter)
 	{
-		return;
+		ThroughputCounter::Add(counter->writeCount, 1);
+		ThroughputCounter::Add(counter->writeBytes, t_bytesTransferred);
 	}
 
-	if (WriteQueue::eBufferType::CURRENT == transmissibleBufferType)
+	if (nullptr != m_monitor)
 	{
-		m_writeQueue.Switch();
+		m_monitor->OnSent(m_sid, t_bytesTransferred);
 	}
 
-	SetWriteState(eWriteState::WRITING);
+	SetWriteState(eWriteState::IDEL);
 
-	WriteQueue::_streambuf_t::const_buffers_type buffer = m_writeQueue.GetWritingBuffer().data();
-	// 현재 버퍼로는 안되는데?? ㅋㅋ WriingBuffer로 다시한번!!!!!
-	boost::asio::async_write(
-		m_socket, buffer,
-		boost::asio::make_custom_alloc_handler(m_handlerMemory,
-			boost::bind(&Session::HandleWrite, shared_from_this(),
-				boost::asio::placeholders::error,
-				boost::asio::placeholders::bytes_transferred)
-		)
-	);
+	if (m_lowWatermark.load(std::memory_order_relaxed) >= m_writeQueue.GetLength())
+	{
+		StopBlockTimer();
+	}
 
-	std::cout << __FUNCTION__ << " - success." << std::endl;
+	// 대기 중인 버퍼가 있으면 이어서 보낸다.
+	Send();
+
+	// OnWritable에서 다시 쓸 수 있으므로 Send 이후에 알린다.
+	CheckWritable();
 }
 
 void Session::HandleResolve(const boost::system::error_code& t_errorCode, const boost::asio::ip::tcp::resolver::results_type& t_endpoints)
@@ -227,21 +904,36 @@ void Session::HandleResolve(const boost::system::error_code& t_errorCode, const
 
 	// Attempt a connection to each endpoint in the list until we
 	// successfully establish a connection.
-	boost::asio::async_connect(m_socket, t_endpoints,
-		boost::bind(&Session::HandleConnect, shared_from_this(),
-			boost::asio::placeholders::error));
+	StartOperation([this, &t_endpoints](auto&& t_handler) {
+			boost::asio::async_connect(m_socket, t_endpoints, std::move(t_handler));
+		},
+		boost::asio::make_custom_alloc_handler(m_connectMemory,
+			boost::bind(&Session::HandleConnect, shared_from_this(),
+				boost::asio::placeholders::error)
+		)
+	);
 }
 
 void Session::HandleConnect(const boost::system::error_code& t_errorCode)
 {
 	if (t_errorCode)
 	{
-		std::cout << __FUNCTION__ << "- message=" << t_errorCode.message() << std::endl;
+		Log<eLogLevel::WARN>(__FUNCTION__, __LINE__, t_errorCode);
 		// TODO : 에러 노티 필요함. 실패했다!!!
 		OnError(t_errorCode);
 		return;
 	}
 
+	if (nullptr != m_socketOptions)
+	{
+		m_socketOptions->Apply(m_socket, eSocketTarget::CONNECTED);
+	}
+
+	if (auto counter = ThroughputCounter::Current())
+	{
+		ThroughputCounter::Add(counter->connects, 1);
+	}
+
 	// 시작합시다!!!!!
 	Start();
 }
@@ -286,96 +978,270 @@ void Session::OnError(const boost::system::error_code& t_errorCode)
 	m_service->OnError(m_sid, t_errorCode);
 }
 
-void Session::Log(const eLogLevel& t_level, const char* function, const int32_t line, const boost::system::error_code& t_errorCode)
+void Session::OnWritable()
 {
-	Log(t_level, function, line, t_errorCode.to_string());
+	if (false == HasService())
+	{
+		return;
+	}
+
+	m_service->OnWritable(m_sid);
 }
 
-void Session::Log(const eLogLevel& t_level, const char* function, const int32_t line, const std::string_view t_message)
+#pragma endregion R_SESSION
+
+#pragma region R_SUBMIT_QUEUE
+SubmitQueue::SubmitQueue(IoWorker& t_worker)
+	: m_worker(t_worker)
+{
+}
+
+void SubmitQueue::Submit(const _session_ptr_t& t_session, WriteQueue::_holder_t t_holder, const uint8_t* t_data, const std::size_t& t_len, const LatencyStamp& t_stamp)
+{
+	m_queue.Push({ t_session, std::move(t_holder), t_data, t_len, t_stamp });
+
+	Schedule();
+}
+
+void SubmitQueue::Schedule()
 {
-	if (nullptr == m_logging)
+	// 이미 예약되어 있으면 깨우지 않는다.
+	if (true == m_scheduled.exchange(true, std::memory_order_acq_rel))
 	{
 		return;
 	}
 
-	std::stringstream ss;
-	ss << "[" << function << "(" << line << ")] " << t_message;
+	// 큐가 io_context보다 먼저 해제되므로 핸들러 메모리는 executor의 할당자(BufferPool)에서 할당한다.
+	boost::asio::post(m_worker.GetExecutor(), [this]() {
+		Drain();
+		}
+	);
+}
 
-	switch (t_level)
+void SubmitQueue::Drain()
+{
+	// 이 시점 이후에 들어온 요청은 다시 예약된다.
+	m_scheduled.exchange(false, std::memory_order_acq_rel);
+
+	Submission submission;
+	std::size_t count = 0;
+	while (count < MAX_BATCH && true == m_queue.Pop(submission))
 	{
-	case eLogLevel::TRACE:
-		m_logging->Trace(ss.str());
-		break;
-	case eLogLevel::DEBUG:
-		m_logging->Debug(ss.str());
-		break;
+		submission.session->Deliver(std::move(submission.holder), submission.data, submission.length, submission.stamp);
+		submission.session.reset();
+		++count;
+	}
 
-	case eLogLevel::INFO:
-		m_logging->Info(ss.str());
-		break;
+	if (MAX_BATCH <= count)
+	{
+		Schedule();
+	}
+}
+#pragma endregion R_SUBMIT_QUEUE
 
-	case eLogLevel::WARN:
-		m_logging->Warnning(ss.str());
-		break;
+#pragma region R_SESSION_POOL
+SessionPool::SessionPool(IoWorker& t_worker, const std::size_t t_capacity, _destroy_callback_t&& t_destroyCallback)
+	: m_worker(t_worker)
+	, m_capacity(t_capacity)
+	, m_destroyCallback(std::move(t_destroyCallback))
+{
+	m_idle.reserve(m_capacity);
+}
 
-	case eLogLevel::ERR:
-		m_logging->Error(ss.str());
-		break;
+SessionPool::~SessionPool()
+{
+	Close();
+}
 
-	default:
-		break;
+void SessionPool::Warmup(const std::size_t t_count)
+{
+	std::size_t count = std::min(t_count, m_capacity);
+
+	std::lock_guard lock(m_mutex);
+	while (false == m_closed && count > m_idle.size())
+	{
+		m_idle.push_back(Create());
 	}
 }
 
-#pragma endregion R_SESSION
+_session_ptr_t SessionPool::Acquire(const _sid_t& t_sid, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor)
+{
+	Session* session = nullptr;
+	{
+		std::lock_guard lock(m_mutex);
+		if (false == m_idle.empty())
+		{
+			session = m_idle.back();
+			m_idle.pop_back();
+		}
+	}
 
-#pragma region R_SESSION_MANAGER
-bool SessionManager::Create(_io_context_t& t_ioContext, IListener* t_service, ILogging* t_logging, IMonitor* t_monitor, _session_ptr_t& t_session)
+	if (nullptr == session)
+	{
+		session = Create();
+	}
+	else
+	{
+		m_reused.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	session->Reuse(t_sid, t_service, t_logger, t_monitor);
+
+	return _session_ptr_t(session, Deleter{ shared_from_this() }, PoolAllocator<Session>());
+}
+
+void SessionPool::Close()
 {
-	_sid_t sid = GeneratedSID();
+	std::vector<Session*> sessions;
+	{
+		std::lock_guard lock(m_mutex);
+		m_closed = true;
+		sessions.swap(m_idle);
+	}
 
-	t_session = boost::make_shared<Session>(sid, t_ioContext, t_service, t_logging, t_monitor,
-		[this](const auto& sid) {
-			Remove(sid);
-		}
-	);
+	for (auto session : sessions)
+	{
+		delete session;
+	}
+}
+
+void SessionPool::GetStats(SessionPoolStats& t_stats)
+{
+	t_stats.created += m_created.load(std::memory_order_relaxed);
+	t_stats.reused += m_reused.load(std::memory_order_relaxed);
+
+	std::lock_guard lock(m_mutex);
+	t_stats.idle += m_idle.size();
+}
+
+Session* SessionPool::Create()
+{
+	m_created.fetch_add(1, std::memory_order_relaxed);
+
+	return new Session(0, m_worker, nullptr, Logger(), nullptr, _destroy_callback_t(m_destroyCallback));
+}
+
+void SessionPool::Release(Session* t_session)
+{
+	// 아무 스레드에서나 호출된다.(마지막 참조를 해제한 스레드)
+	t_session->Reset();
 
-	if (nullptr == t_session)
 	{
-		return false;
+		std::lock_guard lock(m_mutex);
+		if (false == m_closed && m_capacity > m_idle.size())
+		{
+			m_idle.push_back(t_session);
+			return;
+		}
 	}
 
-	Add(sid, t_session);
+	delete t_session;
+}
+#pragma endregion R_SESSION_POOL
 
-	return true;
+#pragma region R_SESSION_MANAGER
+SessionManager::SessionManager(const uint32_t t_numberOfShards)
+	: m_sessionTable(t_numberOfShards)
+	, m_pools(t_numberOfShards)
+{
 }
 
-bool SessionManager::Lookup(const _sid_t& t_sid, _session_ptr_t& t_session)
+SessionManager::~SessionManager()
 {
-	std::shared_lock lock(m_rwMutex);
+	// 아직 사용 중인 세션은 해제될 때 풀로 돌아오지 않고 해제된다.
+	for (auto& pool : m_pools)
+	{
+		if (nullptr != pool)
+		{
+			pool->Close();
+		}
+	}
+}
 
-	auto itr = m_sessionMap.find(t_sid);
-	if (itr == m_sessionMap.end())
+bool SessionManager::Create(IoWorker& t_worker, IListener* t_service, const Logger& t_logger, IMonitor* t_monitor, _session_ptr_t& t_session)
+{
+	_sid_t sid = GeneratedSID(t_worker);
+	if (0 == sid)
 	{
 		return false;
 	}
 
-	t_session = itr->second;
+	const _session_pool_ptr_t& pool = m_pools[t_worker.GetIndex()];
+	if (nullptr != pool)
+	{
+		t_session = pool->Acquire(sid, t_service, t_logger, t_monitor);
+	}
+	else
+	{
+		t_session = boost::make_shared<Session>(sid, t_worker, t_service, t_logger, t_monitor,
+			[this](const auto& sid) {
+				Remove(sid);
+			}
+		);
+	}
+
+	if (nullptr == t_session)
+	{
+		Remove(sid);
+		return false;
+	}
+
+	Add(sid, t_session);
 
 	return true;
 }
 
+bool SessionManager::Lookup(const _sid_t& t_sid, _session_ptr_t& t_session)
+{
+	return m_sessionTable.Lookup(t_sid, t_session);
+}
+
 bool SessionManager::Add(const _sid_t& t_sid, const _session_ptr_t& t_session)
 {
-	std::unique_lock lock(m_rwMutex);
-	
-	return m_sessionMap.emplace(t_sid, t_session).second;
+	return m_sessionTable.Add(t_sid, t_session);
 }
 
 void SessionManager::Remove(const _sid_t& t_sid)
 {
-	std::unique_lock lock(m_rwMutex);
-	m_sessionMap.erase(t_sid);
+	m_sessionTable.Remove(t_sid);
+}
+
+void SessionManager::CreatePool(IoWorker& t_worker, const std::size_t t_capacity, const std::size_t t_warmup)
+{
+	_session_pool_ptr_t& pool = m_pools[t_worker.GetIndex()];
+	if (nullptr != pool || 0 == t_capacity)
+	{
+		return;
+	}
+
+	pool = std::make_shared<SessionPool>(t_worker, t_capacity,
+		[this](const auto& sid) {
+			Remove(sid);
+		}
+	);
+
+	if (0 < t_warmup)
+	{
+		// 핸들러가 풀의 수명을 늘리지 않도록 weak_ptr로 넘긴다.
+		boost::asio::post(t_worker.GetExecutor(), [weakPool = std::weak_ptr<SessionPool>(pool), t_warmup]() {
+			if (auto sessionPool = weakPool.lock())
+			{
+				sessionPool->Warmup(t_warmup);
+			}
+			}
+		);
+	}
+}
+
+void SessionManager::GetPoolStats(SessionPoolStats& t_stats)
+{
+	for (auto& pool : m_pools)
+	{
+		if (nullptr != pool)
+		{
+			pool->GetStats(t_stats);
+		}
+	}
 }
 #pragma endregion R_SESSION_MANAGER
 }
@@ -0,0 +1,249 @@
+#include <sstream>
+#include "socket_option.h"
+
+namespace net
+{
+namespace
+{
+template <typename Option>
+inline int32_t GetValue(const Option& t_option)
+{
+	return static_cast<int32_t>(t_option.value());
+}
+
+inline int32_t GetValue(const boost::asio::socket_base::linger& t_option)
+{
+	return t_option.enabled() ? t_option.timeout() : -1;
+}
+
+// 설정 후 다시 읽어서 실제 값을 기록한다.
+template <typename Socket, typename Option>
+void SetOption(Socket& t_socket, const char* t_name, const int32_t t_requested, const Option& t_option, _socket_option_report_t& t_report)
+{
+	SocketOptionResult result;
+	result.name = t_name;
+	result.requested = t_requested;
+
+	boost::system::error_code errorCode;
+	t_socket.set_option(t_option, errorCode);
+	if (errorCode)
+	{
+		result.message = errorCode.message();
+		t_report.push_back(std::move(result));
+		return;
+	}
+
+	Option current;
+	t_socket.get_option(current, errorCode);
+	result.actual = errorCode ? t_requested : GetValue(current);
+	result.applied = true;
+
+	t_report.push_back(std::move(result));
+}
+
+[[maybe_unused]] void NotSupported(const char* t_name, const int32_t t_requested, _socket_option_report_t& t_report)
+{
+	SocketOptionResult result;
+	result.name = t_name;
+	result.requested = t_requested;
+	result.message = "not supported on this platform";
+
+	t_report.push_back(std::move(result));
+}
+
+const char* GetTargetName(const eSocketTarget& t_target)
+{
+	switch (t_target)
+	{
+	case eSocketTarget::LISTEN:
+		return "LISTEN";
+	case eSocketTarget::ACCEPTED:
+		return "ACCEPTED";
+	case eSocketTarget::CONNECTED:
+		return "CONNECTED";
+	default:
+		return "UNKNOWN";
+	}
+}
+}
+
+SocketOptions::SocketOptions(IConfiguration* t_configuration, const Logger& t_logger)
+	: m_configuration(t_configuration)
+	, m_logger(t_logger)
+{
+}
+
+void SocketOptions::Apply(_acceptor_t& t_acceptor, const bool t_reusePort, _socket_option_report_t& t_report)
+{
+	// 지정하지 않으면 이전과 같이 SO_REUSEADDR를 사용한다.
+	bool reuse = m_configuration->Reuse().value_or(true);
+	SetOption(t_acceptor, "SO_REUSEADDR", reuse, boost::asio::socket_base::reuse_address(reuse), t_report);
+
+	if (true == t_reusePort)
+	{
+#ifdef SO_REUSEPORT
+		using _reuse_port_t = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+		SetOption(t_acceptor, "SO_REUSEPORT", 1, _reuse_port_t(true), t_report);
+#else
+		NotSupported("SO_REUSEPORT", 1, t_report);
+#endif
+	}
+
+	ApplyBufferSize(t_acceptor, t_report);
+	ApplySegmentSize(t_acceptor, t_report);
+}
+
+void SocketOptions::Listen(_acceptor_t& t_acceptor, _socket_option_report_t&& t_report)
+{
+	// value_or는 참조로 받으므로 정의가 없는 static 멤버를 값으로 넘긴다.(최적화하지 않으면 링크 에러)
+	int32_t backlog = m_configuration->Backlog().value_or(static_cast<int32_t>(boost::asio::socket_base::max_listen_connections));
+
+	SocketOptionResult result;
+	result.name = "BACKLOG";
+	result.requested = backlog;
+	result.actual = backlog;
+
+	boost::system::error_code errorCode;
+	t_acceptor.listen(backlog, errorCode);
+	result.applied = !errorCode;
+	result.message = errorCode ? errorCode.message() : "";
+
+	t_report.push_back(result);
+
+	Report(eSocketTarget::LISTEN, std::move(t_report));
+
+	if (errorCode)
+	{
+		throw boost::system::system_error(errorCode);
+	}
+}
+
+void SocketOptions::Apply(_socket_t& t_socket, const eSocketTarget& t_target)
+{
+	// 연결마다 호출되므로 스레드별 목록을 재사용한다.(결과는 대상별로 처음 한번만 기록한다.)
+	thread_local _socket_option_report_t report;
+	report.clear();
+
+	if (auto nagle = m_configuration->Nagle())
+	{
+		SetOption(t_socket, "TCP_NODELAY", !nagle.value(), boost::asio::ip::tcp::no_delay(!nagle.value()), report);
+	}
+
+	if (auto keepalive = m_configuration->Keepalive())
+	{
+		SetOption(t_socket, "SO_KEEPALIVE", keepalive.value(), boost::asio::socket_base::keep_alive(keepalive.value()), report);
+	}
+
+	if (auto linger = m_configuration->Linger())
+	{
+		int32_t requested = linger->first ? linger->second : -1;
+		SetOption(t_socket, "SO_LINGER", requested, boost::asio::socket_base::linger(linger->first, linger->second), report);
+	}
+
+	ApplyBufferSize(t_socket, report);
+
+	if (auto quickAck = m_configuration->QuickAck())
+	{
+#ifdef TCP_QUICKACK
+		using _quick_ack_t = boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK>;
+		SetOption(t_socket, "TCP_QUICKACK", quickAck.value(), _quick_ack_t(quickAck.value()), report);
+#else
+		NotSupported("TCP_QUICKACK", quickAck.value(), report);
+#endif
+	}
+
+	if (auto notSentLowat = m_configuration->NotSentLowat())
+	{
+#ifdef TCP_NOTSENT_LOWAT
+		using _not_sent_lowat_t = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT>;
+		SetOption(t_socket, "TCP_NOTSENT_LOWAT", notSentLowat.value(), _not_sent_lowat_t(notSentLowat.value()), report);
+#else
+		NotSupported("TCP_NOTSENT_LOWAT", notSentLowat.value(), report);
+#endif
+	}
+
+	if (auto busyPoll = m_configuration->BusyPoll())
+	{
+#ifdef SO_BUSY_POLL
+		using _busy_poll_t = boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>;
+		SetOption(t_socket, "SO_BUSY_POLL", busyPoll.value(), _busy_poll_t(busyPoll.value()), report);
+#else
+		NotSupported("SO_BUSY_POLL", busyPoll.value(), report);
+#endif
+	}
+
+	if (false == m_reported[static_cast<std::size_t>(t_target)].load(std::memory_order_acquire))
+	{
+		Report(t_target, _socket_option_report_t(report));
+	}
+}
+
+void SocketOptions::GetReport(const eSocketTarget& t_target, _socket_option_report_t& t_report)
+{
+	std::lock_guard lock(m_mutex);
+	t_report = m_reports[static_cast<std::size_t>(t_target)];
+}
+
+template <typename Socket>
+void SocketOptions::ApplyBufferSize(Socket& t_socket, _socket_option_report_t& t_report)
+{
+	if (auto receiveBufferSize = m_configuration->ReceiveBufferSize())
+	{
+		SetOption(t_socket, "SO_RCVBUF", receiveBufferSize.value(), boost::asio::socket_base::receive_buffer_size(receiveBufferSize.value()), t_report);
+	}
+
+	if (auto sendBufferSize = m_configuration->SendBufferSize())
+	{
+		SetOption(t_socket, "SO_SNDBUF", sendBufferSize.value(), boost::asio::socket_base::send_buffer_size(sendBufferSize.value()), t_report);
+	}
+}
+
+template <typename Socket>
+void SocketOptions::ApplySegmentSize(Socket& t_socket, _socket_option_report_t& t_report)
+{
+	auto segmentSize = m_configuration->MMS();
+	if (false == segmentSize.has_value())
+	{
+		return;
+	}
+
+#ifdef TCP_MAXSEG
+	using _max_segment_t = boost::asio::detail::socket_option::integer<IPPROTO_TCP, TCP_MAXSEG>;
+	SetOption(t_socket, "TCP_MAXSEG", segmentSize.value(), _max_segment_t(segmentSize.value()), t_report);
+#else
+	NotSupported("TCP_MAXSEG", segmentSize.value(), t_report);
+#endif
+}
+
+void SocketOptions::Report(const eSocketTarget& t_target, _socket_option_report_t&& t_report)
+{
+	// 대상별로 처음 적용한 결과만 기록한다.
+	if (true == m_reported[static_cast<std::size_t>(t_target)].exchange(true))
+	{
+		return;
+	}
+
+	if (true == m_logger.IsEnabled<eLogLevel::WARN>())
+	{
+		for (auto& result : t_report)
+		{
+			std::stringstream ss;
+			ss << "[SocketOption] " << GetTargetName(t_target) << " " << result.name
+				<< " requested=" << result.requested << " actual=" << result.actual;
+
+			if (true == result.applied)
+			{
+				m_logger.Write<eLogLevel::INFO>(__FUNCTION__, __LINE__, ss.str());
+			}
+			else
+			{
+				ss << " failed. message=" << result.message;
+				m_logger.Write<eLogLevel::WARN>(__FUNCTION__, __LINE__, ss.str());
+			}
+		}
+	}
+
+	std::lock_guard lock(m_mutex);
+	m_reports[static_cast<std::size_t>(t_target)] = std::move(t_report);
+}
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include "timer_wheel.h"
+
+namespace net
+{
+#pragma region R_TIMER_WHEEL
+TimerWheel::~TimerWheel()
+{
+	std::lock_guard lock(m_mutex);
+
+	for (auto& level : m_levels)
+	{
+		for (auto& slot : level)
+		{
+			while (nullptr != slot)
+			{
+				Unlink(*slot);
+			}
+		}
+	}
+}
+
+void TimerWheel::Schedule(Node& t_node, const uint64_t t_expire)
+{
+	std::lock_guard lock(m_mutex);
+
+	if (this == t_node.m_wheel.load(std::memory_order_relaxed))
+	{
+		Unlink(t_node);
+	}
+
+	uint64_t tick = m_tick.load(std::memory_order_relaxed);
+	t_node.m_expire = std::max(t_expire, tick + 1);
+
+	Link(t_node);
+}
+
+void TimerWheel::Cancel(Node& t_node)
+{
+	TimerWheel* wheel = t_node.m_wheel.load(std::memory_order_acquire);
+	if (nullptr == wheel)
+	{
+		return;
+	}
+
+	std::lock_guard lock(wheel->m_mutex);
+
+	// lock을 잡는 사이 만료되었을 수 있다.
+	if (wheel == t_node.m_wheel.load(std::memory_order_relaxed))
+	{
+		wheel->Unlink(t_node);
+	}
+}
+
+void TimerWheel::Advance(const uint64_t t_tick)
+{
+	std::lock_guard lock(m_mutex);
+
+	uint64_t tick = m_tick.load(std::memory_order_relaxed);
+	while (tick < t_tick)
+	{
+		++tick;
+		m_tick.store(tick, std::memory_order_relaxed);
+
+		// 하위 레벨이 한 바퀴 돌았으면 상위 레벨의 다음 슬롯을 내린다.
+		for (uint32_t level = 1; level < LEVELS && 0 == GetIndex(tick, level - 1); ++level)
+		{
+			Cascade(level);
+		}
+
+		_slot_t& slot = m_levels[0][GetIndex(tick, 0)];
+		while (nullptr != slot)
+		{
+			Node& node = *slot;
+			Unlink(node);
+			node.OnExpire();
+		}
+	}
+}
+
+void TimerWheel::Link(Node& t_node)
+{
+	uint64_t tick = m_tick.load(std::memory_order_relaxed);
+	uint64_t delta = t_node.m_expire - tick;
+
+	// 범위를 넘으면 범위 끝에 건다.(만료되면 소유자가 다시 건다.)
+	if (MAX_TICKS < delta)
+	{
+		t_node.m_expire = tick + MAX_TICKS;
+		delta = MAX_TICKS;
+	}
+
+	uint32_t level = 0;
+	while (level + 1 < LEVELS && (uint64_t(1) << (SLOT_BITS * (level + 1))) <= delta)
+	{
+		++level;
+	}
+
+	_slot_t& slot = m_levels[level][GetIndex(t_node.m_expire, level)];
+
+	t_node.m_prev = nullptr;
+	t_node.m_next = slot;
+	if (nullptr != slot)
+	{
+		slot->m_prev = &t_node;
+	}
+	slot = &t_node;
+
+	t_node.m_wheel.store(this, std::memory_order_release);
+	++m_size;
+}
+
+void TimerWheel::Unlink(Node& t_node)
+{
+	if (nullptr != t_node.m_prev)
+	{
+		t_node.m_prev->m_next = t_node.m_next;
+	}
+	else
+	{
+		// 리스트의 처음이면 슬롯을 찾아서 갱신한다.
+		for (auto& level : m_levels)
+		{
+			_slot_t& slot = level[GetIndex(t_node.m_expire, static_cast<uint32_t>(&level - m_levels.data()))];
+			if (&t_node == slot)
+			{
+				slot = t_node.m_next;
+				break;
+			}
+		}
+	}
+
+	if (nullptr != t_node.m_next)
+	{
+		t_node.m_next->m_prev = t_node.m_prev;
+	}
+
+	t_node.m_prev = nullptr;
+	t_node.m_next = nullptr;
+	t_node.m_wheel.store(nullptr, std::memory_order_release);
+	--m_size;
+}
+
+void TimerWheel::Cascade(const uint32_t t_level)
+{
+	uint64_t tick = m_tick.load(std::memory_order_relaxed);
+
+	_slot_t& slot = m_levels[t_level][GetIndex(tick, t_level)];
+
+	_slot_t list = slot;
+	slot = nullptr;
+
+	while (nullptr != list)
+	{
+		Node& node = *list;
+		list = node.m_next;
+
+		--m_size;
+		Link(node);
+	}
+}
+#pragma endregion R_TIMER_WHEEL
+}